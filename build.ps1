@@ -1,34 +1,19 @@
-# building shaders
-glslc.exe .\shaders\objectShader.vert -o .\shaders\objectShader.vert.spv
-if ($LASTEXITCODE -ne 0) { exit 1 }
-glslc.exe .\shaders\objectShader.frag -o .\shaders\objectShader.frag.spv
-if ($LASTEXITCODE -ne 0) { exit 1 }
-glslc.exe .\shaders\shadowMapShader.vert -o .\shaders\shadowMapShader.vert.spv
-if ($LASTEXITCODE -ne 0) { exit 1 }
-glslc.exe .\shaders\shadowMapShader.frag -o .\shaders\shadowMapShader.frag.spv
-if ($LASTEXITCODE -ne 0) { exit 1 }
-
-cd .\lib\embedFiles
-.\buildEmbedFiles.ps1
-cd ..\..
-.\lib\embedFiles\build\windows\Release\embedFiles.exe
-
-rm -r -fo .\shaders\objectShader.vert.spv
-rm -r -fo .\shaders\objectShader.frag.spv
-rm -r -fo .\shaders\shadowMapShader.vert.spv
-rm -r -fo .\shaders\shadowMapShader.frag.spv
-
 echo ""; echo "Building Project VulkanFlappyBird..."; echo ""
 
+# compiles the shaders and textures and embeds them with static\ on the way
 cmake -DCMAKE_CXX_FLAGS="/EHsc" -G "Visual Studio 17 2022" -A x64 -S . -B .\build\windows
 if ($LASTEXITCODE -ne 0) { exit 1 }
 
 cmake --build .\build\windows --config Release --target VulkanFlappyBird
 if ($LASTEXITCODE -ne 0) { exit 1 }
 
-xcopy .\static .\build\windows\Release\static /s /i /q /y
+# with EMBEDDED_ASSETS 0 static\ and the compiled textures are in assets.pak
+if (Test-Path .\build\windows\assets.pak) { cp -fo .\build\windows\assets.pak .\build\windows\Release }
+elseif (Test-Path .\build\windows\Release\assets.pak) { rm -fo .\build\windows\Release\assets.pak }
 
 echo "Done!"
 echo ""; echo "Executing..."; echo ""
 
-.\build\windows\Release\VulkanFlappyBird.exe
+# run from Release so it picks up assets.pak
+cd .\build\windows\Release
+.\VulkanFlappyBird.exe
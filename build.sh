@@ -1,33 +1,23 @@
 #!/bin/bash
 set -euxo
 
-cd ./shaders
-for vertFile in *.vert; do glslc $vertFile -o "$vertFile.spv"; done
-for fragFile in *.frag; do glslc $fragFile -o "$fragFile.spv"; done
-cd ../
-
-cd ./lib/embedFiles
-./buildEmbedFiles.sh
-cd ../..
-./lib/embedFiles/build/linux/embedFiles
-
-# deleting compiled shaders bc not need them
-cd ./shaders
-for spvFile in *.spv; do rm -rf $spvFile; done
-cd ../
-
 echo; echo "Building Project VulkanFlappyBird..."; echo
 
+# compiles the shaders and textures and embeds them with static/ on the way
 cmake -S . -B build/linux
 cmake --build build/linux --target VulkanFlappyBird
 
+# shaders, static/ and the compiled textures are all in the binary, or
+# with EMBEDDED_ASSETS 0 the last two in assets.pak next to it
 rm -rf ./build/linux/Release
 mkdir ./build/linux/Release
 cp -rf ./build/linux/VulkanFlappyBird ./build/linux/Release
-cp -rf ./static ./build/linux/Release
+if [ -f ./build/linux/assets.pak ]; then cp -f ./build/linux/assets.pak ./build/linux/Release; fi
 
 echo "Done!"
 echo; echo "Executing..."; echo
 
-./build/linux/Release/VulkanFlappyBird
+# run from Release so it picks up assets.pak
+cd ./build/linux/Release
+./VulkanFlappyBird
 
@@ -1,2 +1,5 @@
 rm -r -fo .\build
 rm -r -fo .\lib\embedFiles\build
+rm -r -fo .\lib\packAssets\build
+rm -r -fo .\lib\compileTextures\build
+rm -r -fo .\cache
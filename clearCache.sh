@@ -2,3 +2,6 @@
 
 rm -rf ./build
 rm -rf ./lib/embededFiles/build
+rm -rf ./lib/packAssets/build
+rm -rf ./lib/compileTextures/build
+rm -rf ./cache
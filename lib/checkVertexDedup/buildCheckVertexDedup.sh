@@ -0,0 +1,7 @@
+#!/bin/bash
+set -e
+
+echo; echo "Building Project checkVertexDedup..."; echo
+
+cmake -S . -B ./build/linux
+cmake --build ./build/linux --target checkVertexDedup
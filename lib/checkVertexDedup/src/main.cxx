@@ -0,0 +1,162 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#ifdef IS_WINDOWS
+  #include <windows.h>
+#endif
+
+#include "../../../src/lib/mappedFile.hxx"
+
+// the game also looks in the asset pack, here there are only the loose files
+bool openAsset(const std::string& path, struct MappedFile& file)
+{
+  return mapFile("static/" + path, file);
+}
+
+#include "../../../src/lib/meshTypes.hxx"
+#include "../../../src/lib/obj_loader.hxx"
+
+// Checks VertexDedupTable, the vertex dedup in LoadOBJ, against the
+// std::unordered_map it replaced and times both. Each mesh is loaded with
+// LoadOBJ, which prints its load time as NODEBUG isn't defined here; its
+// triangle corners are then deduplicated again by both, once as they are
+// and once with copies that differ only in material (have to stay apart)
+// or in the sign of a zero (have to merge). Paths are relative to static/
+// like the game's, run it from the repository root. Without arguments it
+// takes the bird and the tubes. The .mtl next to each .obj is read too.
+//   checkVertexDedup [<obj file>...]
+
+const int BENCHMARK_RUNS = 100;
+// added to the material of the copies, more than any mesh here has
+const uint32_t MATERIAL_OFFSET = 1000;
+
+void referenceDedup(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+  std::unordered_map<Vertex, uint32_t> unique;
+  unique.reserve(corners.size());
+  for (const Vertex& corner : corners)
+  {
+    auto inserted = unique.emplace(corner, static_cast<uint32_t>(vertices.size()));
+    if (inserted.second)
+      vertices.push_back(corner);
+    indices.push_back(inserted.first->second);
+  }
+}
+
+void tableDedup(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+  VertexDedupTable table;
+  table.reserve(corners.size());
+  vertices.reserve(corners.size());
+  for (const Vertex& corner : corners)
+    indices.push_back(table.insert(corner, vertices));
+}
+
+// milliseconds per pass
+template <typename Dedup>
+double timeDedup(Dedup dedup, const std::vector<Vertex>& corners)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < BENCHMARK_RUNS; run++)
+  {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    dedup(corners, vertices, indices);
+  }
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  return time.count() * 1000.0 / BENCHMARK_RUNS;
+}
+
+// -0.0f where the vertex has 0.0f
+float flipZero(float value)
+{
+  return value == 0.0f ? -value : value;
+}
+
+bool checkMesh(const std::string& objPath)
+{
+  std::string mtlPath = std::filesystem::path(objPath).replace_extension(".mtl").string();
+  std::vector<struct Material> materials;
+  loadMTL(std::filesystem::exists("static/" + mtlPath) ? mtlPath : "", materials);
+
+  std::vector<Vertex> loadedVertices;
+  std::vector<uint32_t> loadedIndices;
+  LoadOBJ(objPath, materials, loadedVertices, loadedIndices);
+
+  std::vector<Vertex> corners;
+  corners.reserve(loadedIndices.size());
+  for (uint32_t index : loadedIndices)
+    corners.push_back(loadedVertices[index]);
+
+  bool passed = true;
+  // nothing LoadOBJ kept is a duplicate, and the order is the same
+  std::vector<Vertex> referenceVertices;
+  std::vector<uint32_t> referenceIndices;
+  referenceDedup(corners, referenceVertices, referenceIndices);
+  if (referenceVertices != loadedVertices || referenceIndices != loadedIndices)
+  {
+    printf("\033[31mERR:\033[0m \"%s\": LoadOBJ gives %zu vertices, std::unordered_map %zu\n",
+        objPath.c_str(), loadedVertices.size(), referenceVertices.size());
+    passed = false;
+  }
+
+  std::vector<Vertex> variants = corners;
+  for (const Vertex& corner : corners)
+  {
+    Vertex otherMaterial = corner;
+    otherMaterial.material += MATERIAL_OFFSET;
+    variants.push_back(otherMaterial);
+  }
+  for (const Vertex& corner : corners)
+  {
+    Vertex negativeZeros = corner;
+    for (int i = 0; i < 3; i++)
+    {
+      negativeZeros.pos[i] = flipZero(negativeZeros.pos[i]);
+      negativeZeros.normal[i] = flipZero(negativeZeros.normal[i]);
+    }
+    for (int i = 0; i < 2; i++)
+      negativeZeros.texCoord[i] = flipZero(negativeZeros.texCoord[i]);
+    variants.push_back(negativeZeros);
+  }
+  std::vector<Vertex> tableVertices;
+  std::vector<uint32_t> tableIndices;
+  tableDedup(variants, tableVertices, tableIndices);
+  referenceVertices.clear();
+  referenceIndices.clear();
+  referenceDedup(variants, referenceVertices, referenceIndices);
+  if (tableVertices != referenceVertices || tableIndices != referenceIndices || tableVertices.size() != loadedVertices.size() * 2)
+  {
+    printf("\033[31mERR:\033[0m \"%s\": with the material and -0 copies the table gives %zu vertices, std::unordered_map %zu, expected %zu\n",
+        objPath.c_str(), tableVertices.size(), referenceVertices.size(), loadedVertices.size() * 2);
+    passed = false;
+  }
+
+  double tableTime = timeDedup(tableDedup, corners);
+  double referenceTime = timeDedup(referenceDedup, corners);
+  printf("  dedup of %zu corners to %zu vertices: %.3f ms, std::unordered_map %.3f ms (%.2fx)\n",
+      corners.size(), loadedVertices.size(), tableTime, referenceTime, referenceTime / std::max(tableTime, 1e-9));
+  return passed;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> objPaths = { "obj/flappyBird.obj", "obj/tubes.obj" };
+  if (argc > 1)
+    objPaths.assign(argv + 1, argv + argc);
+
+  bool passed = true;
+  for (const std::string& objPath : objPaths)
+    passed = checkMesh(objPath) && passed;
+
+  if (!passed)
+    return 1;
+  printf("Vertex dedup matches std::unordered_map on %zu mesh%s\n", objPaths.size(), objPaths.size() == 1 ? "" : "es");
+  return 0;
+}
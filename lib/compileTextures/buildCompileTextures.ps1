@@ -0,0 +1,7 @@
+echo ""; echo "Building Project compileTextures..."; echo ""
+
+cmake -G "Visual Studio 17 2022" -A x64 -S . -B .\build\windows
+if ($LASTEXITCODE -ne 0) { exit 1 }
+
+cmake --build .\build\windows --config Release --target compileTextures
+if ($LASTEXITCODE -ne 0) { exit 1 }
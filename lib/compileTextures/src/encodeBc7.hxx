@@ -0,0 +1,203 @@
+// BC7 encoder using only mode 6: one subset, RGBA endpoints with 7 bits
+// plus a shared p-bit per endpoint, and 4 bit indices. That's the mode
+// that suits smooth photographic textures best. Endpoints come from the
+// principal axis of the block, followed by one least squares refinement.
+
+const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct Bc7Endpoint {
+  int color[4]; // 7 bits
+  int pBit;
+};
+
+struct BlockBits {
+  uint64_t low = 0;
+  uint64_t high = 0;
+  uint32_t position = 0;
+
+  void put(uint32_t value, uint32_t bits)
+  {
+    for (uint32_t i = 0; i < bits; i++, position++)
+    {
+      uint64_t bit = (value >> i) & 1;
+      if (position < 64)
+        low |= bit << position;
+      else
+        high |= bit << (position - 64);
+    }
+  }
+};
+
+int bc7Expand(const Bc7Endpoint& endpoint, int channel)
+{
+  return (endpoint.color[channel] << 1) | endpoint.pBit;
+}
+
+// nearest 7 bit + p-bit value, trying both p-bits
+Bc7Endpoint bc7Quantize(const float color[4])
+{
+  Bc7Endpoint best = {};
+  float bestError = std::numeric_limits<float>::max();
+  for (int pBit = 0; pBit < 2; pBit++)
+  {
+    Bc7Endpoint endpoint = {};
+    endpoint.pBit = pBit;
+    float error = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+      endpoint.color[c] = std::clamp(static_cast<int>(std::lround((color[c] - pBit) * 0.5f)), 0, 127);
+      float difference = static_cast<float>(bc7Expand(endpoint, c)) - color[c];
+      error += difference * difference;
+    }
+    if (error < bestError)
+    {
+      bestError = error;
+      best = endpoint;
+    }
+  }
+  return best;
+}
+
+// picks the best index for every pixel, returns the squared error
+float bc7FindIndices(const uint8_t pixels[16][4], const Bc7Endpoint& e0, const Bc7Endpoint& e1, int indices[16])
+{
+  int palette[16][4];
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 4; c++)
+      palette[i][c] = ((64 - BC7_WEIGHTS[i]) * bc7Expand(e0, c) + BC7_WEIGHTS[i] * bc7Expand(e1, c) + 32) >> 6;
+
+  float total = 0.0f;
+  for (int p = 0; p < 16; p++)
+  {
+    int bestError = std::numeric_limits<int>::max();
+    for (int i = 0; i < 16; i++)
+    {
+      int error = 0;
+      for (int c = 0; c < 4; c++)
+      {
+        int difference = palette[i][c] - pixels[p][c];
+        error += difference * difference;
+      }
+      if (error < bestError)
+      {
+        bestError = error;
+        indices[p] = i;
+      }
+    }
+    total += static_cast<float>(bestError);
+  }
+  return total;
+}
+
+void encodeBc7Block(const uint8_t pixels[16][4], uint8_t out[16])
+{
+  float mean[4] = {};
+  for (int p = 0; p < 16; p++)
+    for (int c = 0; c < 4; c++)
+      mean[c] += pixels[p][c] / 16.0f;
+
+  float covariance[4][4] = {};
+  for (int p = 0; p < 16; p++)
+    for (int a = 0; a < 4; a++)
+      for (int b = 0; b < 4; b++)
+        covariance[a][b] += (pixels[p][a] - mean[a]) * (pixels[p][b] - mean[b]);
+
+  // principal axis by power iteration
+  float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  for (int iteration = 0; iteration < 8; iteration++)
+  {
+    float next[4] = {};
+    for (int a = 0; a < 4; a++)
+      for (int b = 0; b < 4; b++)
+        next[a] += covariance[a][b] * axis[b];
+    float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+    if (length < 1e-6f)
+      break;
+    for (int c = 0; c < 4; c++)
+      axis[c] = next[c] / length;
+  }
+
+  float minT = std::numeric_limits<float>::max();
+  float maxT = std::numeric_limits<float>::lowest();
+  for (int p = 0; p < 16; p++)
+  {
+    float t = 0.0f;
+    for (int c = 0; c < 4; c++)
+      t += (pixels[p][c] - mean[c]) * axis[c];
+    minT = std::min(minT, t);
+    maxT = std::max(maxT, t);
+  }
+  float color0[4], color1[4];
+  for (int c = 0; c < 4; c++)
+  {
+    color0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    color1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+  }
+
+  Bc7Endpoint e0 = bc7Quantize(color0);
+  Bc7Endpoint e1 = bc7Quantize(color1);
+  int indices[16];
+  float error = bc7FindIndices(pixels, e0, e1, indices);
+
+  // least squares endpoints for the chosen weights
+  float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  float ax[4] = {}, bx[4] = {};
+  for (int p = 0; p < 16; p++)
+  {
+    float w = BC7_WEIGHTS[indices[p]] / 64.0f;
+    aa += (1.0f - w) * (1.0f - w);
+    ab += (1.0f - w) * w;
+    bb += w * w;
+    for (int c = 0; c < 4; c++)
+    {
+      ax[c] += (1.0f - w) * pixels[p][c];
+      bx[c] += w * pixels[p][c];
+    }
+  }
+  float determinant = aa * bb - ab * ab;
+  if (std::abs(determinant) > 1e-6f)
+  {
+    for (int c = 0; c < 4; c++)
+    {
+      color0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+      color1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    Bc7Endpoint refined0 = bc7Quantize(color0);
+    Bc7Endpoint refined1 = bc7Quantize(color1);
+    int refinedIndices[16];
+    float refinedError = bc7FindIndices(pixels, refined0, refined1, refinedIndices);
+    if (refinedError < error)
+    {
+      e0 = refined0;
+      e1 = refined1;
+      std::copy(refinedIndices, refinedIndices + 16, indices);
+    }
+  }
+
+  // the first index is stored with 3 bits, its top bit has to be 0
+  if (indices[0] >= 8)
+  {
+    std::swap(e0, e1);
+    for (int p = 0; p < 16; p++)
+      indices[p] = 15 - indices[p];
+  }
+
+  BlockBits bits;
+  bits.put(1 << 6, 7); // mode 6
+  for (int c = 0; c < 4; c++)
+  {
+    bits.put(e0.color[c], 7);
+    bits.put(e1.color[c], 7);
+  }
+  bits.put(e0.pBit, 1);
+  bits.put(e1.pBit, 1);
+  bits.put(indices[0], 3);
+  for (int p = 1; p < 16; p++)
+    bits.put(indices[p], 4);
+
+  for (int i = 0; i < 8; i++)
+  {
+    out[i] = static_cast<uint8_t>(bits.low >> (i * 8));
+    out[8 + i] = static_cast<uint8_t>(bits.high >> (i * 8));
+  }
+}
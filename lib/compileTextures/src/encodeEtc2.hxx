@@ -0,0 +1,151 @@
+// ETC2 RGB encoder limited to the individual and differential modes it
+// inherited from ETC1 (the T, H and planar modes are never emitted, which
+// still makes valid ETC2). Every block tries both subblock orientations
+// and both modes with every intensity table and keeps the best.
+
+const int ETC_MODIFIERS[8][2] = {
+  { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+struct EtcSubblock {
+  int base[3];
+  int table;
+  uint32_t indices[8]; // 0 +small, 1 +large, 2 -small, 3 -large
+  int error;
+};
+
+int etcModifier(int table, uint32_t index)
+{
+  int modifier = ETC_MODIFIERS[table][index & 1];
+  return (index & 2) ? -modifier : modifier;
+}
+
+// best table and per pixel modifiers for a fixed base color
+void etcFitSubblock(const uint8_t* pixels[8], struct EtcSubblock& subblock)
+{
+  subblock.error = std::numeric_limits<int>::max();
+  for (int table = 0; table < 8; table++)
+  {
+    int error = 0;
+    uint32_t indices[8];
+    for (int p = 0; p < 8; p++)
+    {
+      int bestError = std::numeric_limits<int>::max();
+      for (uint32_t index = 0; index < 4; index++)
+      {
+        int pixelError = 0;
+        for (int c = 0; c < 3; c++)
+        {
+          int difference = std::clamp(subblock.base[c] + etcModifier(table, index), 0, 255) - pixels[p][c];
+          pixelError += difference * difference;
+        }
+        if (pixelError < bestError)
+        {
+          bestError = pixelError;
+          indices[p] = index;
+        }
+      }
+      error += bestError;
+    }
+    if (error < subblock.error)
+    {
+      subblock.error = error;
+      subblock.table = table;
+      std::copy(indices, indices + 8, subblock.indices);
+    }
+  }
+}
+
+void encodeEtc2Block(const uint8_t pixels[16][4], uint8_t out[8])
+{
+  uint32_t bestHigh = 0;
+  uint32_t bestLow = 0;
+  int bestError = std::numeric_limits<int>::max();
+
+  for (int flip = 0; flip < 2; flip++)
+  {
+    // flip 0: left and right 2x4 halves, flip 1: top and bottom 4x2 halves
+    const uint8_t* halves[2][8];
+    int pixelOf[2][8]; // position in the block, x * 4 + y like the index bits
+    int counts[2] = { 0, 0 };
+    float averages[2][3] = {};
+    for (int y = 0; y < 4; y++)
+    {
+      for (int x = 0; x < 4; x++)
+      {
+        int half = flip ? (y >= 2) : (x >= 2);
+        halves[half][counts[half]] = pixels[y * 4 + x];
+        pixelOf[half][counts[half]] = x * 4 + y;
+        counts[half]++;
+        for (int c = 0; c < 3; c++)
+          averages[half][c] += pixels[y * 4 + x][c] / 8.0f;
+      }
+    }
+
+    for (int differential = 0; differential < 2; differential++)
+    {
+      struct EtcSubblock subblocks[2];
+      int stored[2][3];
+      for (int half = 0; half < 2; half++)
+      {
+        for (int c = 0; c < 3; c++)
+        {
+          if (differential)
+          {
+            stored[half][c] = std::clamp(static_cast<int>(std::lround(averages[half][c] * 31.0f / 255.0f)), 0, 31);
+            // the second color is a 3 bit delta from the first
+            if (half == 1)
+              stored[1][c] = stored[0][c] + std::clamp(stored[1][c] - stored[0][c], -4, 3);
+            subblocks[half].base[c] = (stored[half][c] << 3) | (stored[half][c] >> 2);
+          }
+          else
+          {
+            stored[half][c] = std::clamp(static_cast<int>(std::lround(averages[half][c] / 17.0f)), 0, 15);
+            subblocks[half].base[c] = stored[half][c] * 17;
+          }
+        }
+        etcFitSubblock(halves[half], subblocks[half]);
+      }
+
+      int error = subblocks[0].error + subblocks[1].error;
+      if (error >= bestError)
+        continue;
+      bestError = error;
+
+      uint32_t high = 0;
+      for (int c = 0; c < 3; c++)
+      {
+        uint32_t shift = 28 - c * 8;
+        if (differential)
+          high |= (static_cast<uint32_t>(stored[0][c]) << (shift - 1)) |
+            (static_cast<uint32_t>(stored[1][c] - stored[0][c]) & 7) << (shift - 4);
+        else
+          high |= (static_cast<uint32_t>(stored[0][c]) << shift) | (static_cast<uint32_t>(stored[1][c]) << (shift - 4));
+      }
+      high |= static_cast<uint32_t>(subblocks[0].table) << 5;
+      high |= static_cast<uint32_t>(subblocks[1].table) << 2;
+      high |= static_cast<uint32_t>(differential) << 1;
+      high |= static_cast<uint32_t>(flip);
+
+      uint32_t low = 0;
+      for (int half = 0; half < 2; half++)
+      {
+        for (int p = 0; p < 8; p++)
+        {
+          uint32_t index = subblocks[half].indices[p];
+          low |= ((index >> 1) & 1) << (16 + pixelOf[half][p]);
+          low |= (index & 1) << pixelOf[half][p];
+        }
+      }
+      bestHigh = high;
+      bestLow = low;
+    }
+  }
+
+  // big endian
+  for (int i = 0; i < 4; i++)
+  {
+    out[i] = static_cast<uint8_t>(bestHigh >> (24 - i * 8));
+    out[4 + i] = static_cast<uint8_t>(bestLow >> (24 - i * 8));
+  }
+}
@@ -0,0 +1,273 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <cmath>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../../src/lib/stb_image.h"
+#include "../../../src/lib/ktx2.hxx"
+#include "encodeBc7.hxx"
+#include "encodeEtc2.hxx"
+
+// Offline texture compiler. Every .jpg/.png below the source directory gets
+// its full mip chain built once and written as KTX2 files in each format
+// the game can pick from at runtime:
+//   <name>.bc7.ktx2   desktop GPUs
+//   <name>.etc2.ktx2  mobile GPUs
+//   <name>.rgba8.ktx2 fallback when neither is supported
+//   compileTextures <source directory> <output directory>
+
+struct Image {
+  uint32_t width;
+  uint32_t height;
+  std::vector<uint8_t> pixels; // RGBA8, sRGB
+};
+
+float srgbToLinear(uint8_t value)
+{
+  float c = value / 255.0f;
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t linearToSrgb(float value)
+{
+  float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(std::clamp(std::lround(c * 255.0f), 0L, 255L));
+}
+
+// 2x2 box filter in linear space, odd edges repeat the last texel
+Image downsample(const Image& source)
+{
+  Image result;
+  result.width = std::max(1u, source.width / 2);
+  result.height = std::max(1u, source.height / 2);
+  result.pixels.resize(static_cast<size_t>(result.width) * result.height * 4);
+  for (uint32_t y = 0; y < result.height; y++)
+  {
+    for (uint32_t x = 0; x < result.width; x++)
+    {
+      float sum[4] = {};
+      for (uint32_t dy = 0; dy < 2; dy++)
+      {
+        for (uint32_t dx = 0; dx < 2; dx++)
+        {
+          uint32_t sx = std::min(x * 2 + dx, source.width - 1);
+          uint32_t sy = std::min(y * 2 + dy, source.height - 1);
+          const uint8_t* texel = &source.pixels[(static_cast<size_t>(sy) * source.width + sx) * 4];
+          for (int c = 0; c < 3; c++)
+            sum[c] += srgbToLinear(texel[c]);
+          sum[3] += texel[3] / 255.0f;
+        }
+      }
+      uint8_t* out = &result.pixels[(static_cast<size_t>(y) * result.width + x) * 4];
+      for (int c = 0; c < 3; c++)
+        out[c] = linearToSrgb(sum[c] * 0.25f);
+      out[3] = static_cast<uint8_t>(std::lround(sum[3] * 0.25f * 255.0f));
+    }
+  }
+  return result;
+}
+
+std::vector<uint8_t> encodeLevel(const Image& image, uint32_t vkFormat)
+{
+  if (vkFormat == KTX2_FORMAT_RGBA8_SRGB)
+    return image.pixels;
+
+  std::vector<uint8_t> blocks(ktx2LevelBytes(vkFormat, image.width, image.height));
+  uint32_t blockBytes = ktx2BlockBytes(vkFormat);
+  uint32_t blocksWide = (image.width + 3) / 4;
+  uint32_t blocksHigh = (image.height + 3) / 4;
+  for (uint32_t by = 0; by < blocksHigh; by++)
+  {
+    for (uint32_t bx = 0; bx < blocksWide; bx++)
+    {
+      // row major 4x4, blocks hanging over the edge repeat the last texel
+      uint8_t pixels[16][4];
+      for (uint32_t y = 0; y < 4; y++)
+      {
+        for (uint32_t x = 0; x < 4; x++)
+        {
+          uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+          uint32_t sy = std::min(by * 4 + y, image.height - 1);
+          memcpy(pixels[y * 4 + x], &image.pixels[(static_cast<size_t>(sy) * image.width + sx) * 4], 4);
+        }
+      }
+      uint8_t* out = &blocks[(static_cast<size_t>(by) * blocksWide + bx) * blockBytes];
+      if (vkFormat == KTX2_FORMAT_BC7_SRGB)
+        encodeBc7Block(pixels, out);
+      else
+        encodeEtc2Block(pixels, out);
+    }
+  }
+  return blocks;
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+    out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+}
+
+// basic data format descriptor, required by KTX2
+std::vector<uint8_t> dataFormatDescriptor(uint32_t vkFormat)
+{
+  struct Sample { uint16_t bitOffset; uint8_t bitLength; uint8_t channel; uint32_t upper; };
+  std::vector<Sample> samples;
+  uint8_t model, blockDimension, bytesPlane;
+  if (vkFormat == KTX2_FORMAT_RGBA8_SRGB)
+  {
+    model = 1; // RGBSDA
+    blockDimension = 0;
+    bytesPlane = 4;
+    samples = { { 0, 7, 0, 255 }, { 8, 7, 1, 255 }, { 16, 7, 2, 255 }, { 24, 7, 15 | 0x10, 255 } }; // alpha is linear
+  }
+  else if (vkFormat == KTX2_FORMAT_BC7_SRGB)
+  {
+    model = 134; // BC7
+    blockDimension = 3;
+    bytesPlane = 16;
+    samples = { { 0, 127, 0, 0xFFFFFFFF } };
+  }
+  else
+  {
+    model = 161; // ETC2
+    blockDimension = 3;
+    bytesPlane = 8;
+    samples = { { 0, 63, 2, 0xFFFFFFFF } }; // ETC2 color
+  }
+
+  std::vector<uint8_t> out;
+  uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+  put32(out, 4 + blockSize);
+  put32(out, 0); // Khronos vendor, basic descriptor type
+  put32(out, 2 | (blockSize << 16)); // version 2
+  out.insert(out.end(), { model, 1, 2, 0 }); // BT.709 primaries, sRGB transfer, straight alpha
+  out.insert(out.end(), { blockDimension, blockDimension, 0, 0 });
+  out.insert(out.end(), { bytesPlane, 0, 0, 0, 0, 0, 0, 0 });
+  for (const auto& sample : samples)
+  {
+    put32(out, sample.bitOffset | (sample.bitLength << 16) | (static_cast<uint32_t>(sample.channel) << 24));
+    put32(out, 0); // sample position
+    put32(out, 0); // lower
+    put32(out, sample.upper);
+  }
+  return out;
+}
+
+bool writeKtx2(const std::filesystem::path& path, const std::vector<Image>& mips, uint32_t vkFormat)
+{
+  std::vector<std::vector<uint8_t>> levels;
+  for (const auto& mip : mips)
+    levels.push_back(encodeLevel(mip, vkFormat));
+  std::vector<uint8_t> dfd = dataFormatDescriptor(vkFormat);
+
+  struct Ktx2Header header = {};
+  memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier));
+  header.vkFormat = vkFormat;
+  header.typeSize = 1;
+  header.pixelWidth = mips[0].width;
+  header.pixelHeight = mips[0].height;
+  header.faceCount = 1;
+  header.levelCount = static_cast<uint32_t>(mips.size());
+  header.dfdByteOffset = static_cast<uint32_t>(sizeof(header) + mips.size() * sizeof(struct Ktx2Level));
+  header.dfdByteLength = static_cast<uint32_t>(dfd.size());
+
+  // level data goes smallest first, every level aligned to its block size
+  std::vector<struct Ktx2Level> index(mips.size());
+  uint64_t alignment = ktx2BlockBytes(vkFormat);
+  uint64_t offset = header.dfdByteOffset + dfd.size();
+  for (size_t i = mips.size(); i-- > 0;)
+  {
+    offset = (offset + alignment - 1) / alignment * alignment;
+    index[i].byteOffset = offset;
+    index[i].byteLength = levels[i].size();
+    index[i].uncompressedByteLength = levels[i].size();
+    offset += levels[i].size();
+  }
+
+  std::ofstream outFile(path, std::ios::binary);
+  if (!outFile)
+    return false;
+  outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  outFile.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(struct Ktx2Level));
+  outFile.write(reinterpret_cast<const char*>(dfd.data()), dfd.size());
+  for (size_t i = mips.size(); i-- > 0;)
+  {
+    outFile.seekp(static_cast<std::streamoff>(index[i].byteOffset));
+    outFile.write(reinterpret_cast<const char*>(levels[i].data()), levels[i].size());
+  }
+  outFile.close();
+  return static_cast<bool>(outFile);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    printf("Usage: %s <source directory> <output directory>\n", argv[0]);
+    return 1;
+  }
+  std::filesystem::path sourceDirectory = argv[1];
+  std::filesystem::path outDirectory = argv[2];
+
+  std::vector<std::filesystem::path> sources;
+  std::error_code error;
+  for (const auto& item : std::filesystem::recursive_directory_iterator(sourceDirectory, error))
+  {
+    std::string extension = item.path().extension().string();
+    if (item.is_regular_file() && (extension == ".jpg" || extension == ".png"))
+      sources.push_back(std::filesystem::relative(item.path(), sourceDirectory));
+  }
+  if (error)
+  {
+    printf("\033[31mERR:\033[0m Failed to read directory \"%s\"\n", argv[1]);
+    exit(-1);
+  }
+
+  const struct { uint32_t vkFormat; const char* suffix; } formats[] = {
+    { KTX2_FORMAT_BC7_SRGB, ".bc7.ktx2" },
+    { KTX2_FORMAT_ETC2_RGB8_SRGB, ".etc2.ktx2" },
+    { KTX2_FORMAT_RGBA8_SRGB, ".rgba8.ktx2" },
+  };
+
+  for (const auto& source : sources)
+  {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load((sourceDirectory / source).string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels)
+    {
+      printf("\033[31mERR:\033[0m Failed to load texture \"%s\"\n", source.string().c_str());
+      exit(-1);
+    }
+
+    std::vector<Image> mips(1);
+    mips[0].width = static_cast<uint32_t>(width);
+    mips[0].height = static_cast<uint32_t>(height);
+    mips[0].pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    while (mips.back().width > 1 || mips.back().height > 1)
+      mips.push_back(downsample(mips.back()));
+
+    std::filesystem::path outBase = outDirectory / source;
+    std::filesystem::create_directories(outBase.parent_path(), error);
+    outBase.replace_extension();
+    for (const auto& format : formats)
+    {
+      std::filesystem::path outPath = outBase.string() + format.suffix;
+      if (!writeKtx2(outPath, mips, format.vkFormat))
+      {
+        printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", outPath.string().c_str());
+        exit(-1);
+      }
+      printf("  %s, %ux%u, %zu levels, %llu bytes\n", outPath.string().c_str(), width, height, mips.size(),
+          static_cast<unsigned long long>(std::filesystem::file_size(outPath, error)));
+    }
+  }
+  printf("Compiled %zu textures\n", sources.size());
+  return 0;
+}
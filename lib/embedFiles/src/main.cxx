@@ -2,36 +2,125 @@
 #include <fstream>
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <algorithm>
+#include <filesystem>
 
-#include "base64.hxx"
+#include "../../../src/lib/assetPackFormat.hxx"
+#include "../../../src/lib/lz4.hxx"
 
-std::string readFile(const std::string filePath);
-void writeFile(const std::string filePath, std::unordered_map<std::string, std::string>& texts);
+// Packs the compiled shaders and every file below the asset directories into
+// one LZ4 compressed blob with a table of contents (see EmbeddedEntry in
+// src/lib/assetPackFormat.hxx) and writes it as a byte array the game links
+// in. The game's CMake runs it from its build directory, which is where it
+// compiles the shaders to. Shaders are read from shaders/ there and named
+// "shaders/<file>". Assets are named relative to the directory they were
+// found in like lib/packAssets does.
+//   embedFiles <output header> [<asset directory>...]
 
-int main (int argc, char** argv)
+std::string readFile(const std::filesystem::path& filePath);
+void writeFile(const std::string& filePath, const std::string& blob);
+
+int main(int argc, char** argv)
 {
-  std::string objectVertShader = readFile("shaders/objectShader.vert.spv");
-  std::string objectFragShader = readFile("shaders/objectShader.frag.spv");
-  std::string shadowMapVertShader = readFile("shaders/shadowMapShader.vert.spv");
-  std::string shadowMapFragShader = readFile("shaders/shadowMapShader.frag.spv");
-  std::unordered_map<std::string, std::string> texts;
-  texts["objectVertShaderCodeBase64"] = base64_encode(objectVertShader, false);
-  texts["objectFragShaderCodeBase64"] = base64_encode(objectFragShader, false);
-  texts["shadowMapVertShaderCodeBase64"] = base64_encode(shadowMapVertShader, false);
-  texts["shadowMapFragShaderCodeBase64"] = base64_encode(shadowMapFragShader, false);
-  writeFile("src/lib/embededFiles.hxx", texts);
+  if (argc < 2)
+  {
+    printf("Usage: %s <output header> [<asset directory>...]\n", argv[0]);
+    return 1;
+  }
+
+  // name -> file it comes from
+  std::vector<std::pair<std::string, std::filesystem::path>> files = {
+    { "shaders/objectShader.vert.spv", "shaders/objectShader.vert.spv" },
+    { "shaders/objectShader.frag.spv", "shaders/objectShader.frag.spv" },
+    { "shaders/objectShaderNonUniform.frag.spv", "shaders/objectShaderNonUniform.frag.spv" },
+    { "shaders/shadowMapShader.vert.spv", "shaders/shadowMapShader.vert.spv" },
+    { "shaders/shadowMapShader.frag.spv", "shaders/shadowMapShader.frag.spv" },
+  };
+  for (int i = 2; i < argc; i++)
+  {
+    std::filesystem::path sourceDirectory = argv[i];
+    std::error_code error;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(sourceDirectory, error))
+      if (item.is_regular_file())
+        files.emplace_back(std::filesystem::relative(item.path(), sourceDirectory).generic_string(), item.path());
+    if (error)
+    {
+      printf("\033[31mERR:\033[0m Failed to read directory \"%s\"\n", argv[i]);
+      exit(-1);
+    }
+  }
+  // the runtime looks names up with a binary search
+  std::sort(files.begin(), files.end());
+  for (size_t i = 1; i < files.size(); i++)
+  {
+    if (files[i].first == files[i - 1].first)
+    {
+      printf("\033[31mERR:\033[0m \"%s\" is in more than one source directory\n", files[i].first.c_str());
+      exit(-1);
+    }
+  }
+
+  struct AssetPackHeader header = {};
+  header.magic = EMBEDDED_BLOB_MAGIC;
+  header.version = EMBEDDED_BLOB_VERSION;
+  header.entryCount = static_cast<uint32_t>(files.size());
+
+  std::vector<struct EmbeddedEntry> entries(files.size());
+  std::string nameBlob;
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    entries[i].nameOffset = static_cast<uint32_t>(nameBlob.size());
+    entries[i].nameLength = static_cast<uint32_t>(files[i].first.size());
+    nameBlob += files[i].first;
+  }
+  header.nameBytes = static_cast<uint32_t>(nameBlob.size());
+
+  std::string payloads;
+  uint64_t offset = sizeof(header) + entries.size() * sizeof(struct EmbeddedEntry) + nameBlob.size();
+  uint64_t totalSize = 0;
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    std::string payload = readFile(files[i].second);
+    std::string packed = lz4Compress(payload.data(), payload.size());
+    std::string unpacked(payload.size(), '\0');
+    if (!lz4Decompress(packed.data(), packed.size(), unpacked.data(), unpacked.size()) || unpacked != payload)
+    {
+      printf("\033[31mERR:\033[0m \"%s\" doesn't survive compression\n", files[i].first.c_str());
+      exit(-1);
+    }
+    // already compressed formats (jpg, BC7) are stored as they are
+    if (packed.size() >= payload.size())
+      packed = payload;
+
+    entries[i].offset = offset + payloads.size();
+    entries[i].packedSize = packed.size();
+    entries[i].size = payload.size();
+    entries[i].hash = hashBytes(payload.data(), payload.size());
+    payloads += packed;
+    totalSize += payload.size();
+    printf("  %s, %zu -> %zu bytes\n", files[i].first.c_str(), payload.size(), packed.size());
+  }
+
+  std::string blob;
+  blob.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  blob.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(struct EmbeddedEntry));
+  blob += nameBlob;
+  blob += payloads;
+  writeFile(argv[1], blob);
+
+  printf("Embedded %zu files, %llu bytes compressed to %zu\n", files.size(),
+      static_cast<unsigned long long>(totalSize), blob.size());
   return 0;
 }
 
-std::string readFile(const std::string filePath)
+std::string readFile(const std::filesystem::path& filePath)
 {
   std::ifstream file;
   file.open(filePath, std::ios::binary);
   if (!file)
   {
-		printf("\033[31mERR:\033[0m Failed to open file \"%s\"\n", filePath.data());
-		exit(-1);
+    printf("\033[31mERR:\033[0m Failed to open file \"%s\"\n", filePath.string().data());
+    exit(-1);
   }
   file.seekg(0, std::ios::end);
   size_t fileSizeInByte = file.tellg();
@@ -39,25 +128,33 @@ std::string readFile(const std::string filePath)
   buffer.resize(fileSizeInByte);
   file.seekg(0, std::ios::beg);
   file.read(&buffer[0], fileSizeInByte);
-	return buffer;
+  return buffer;
 }
 
-void writeFile(const std::string filePath, std::unordered_map<std::string, std::string>& texts)
+// a byte array instead of a string literal, MSVC caps those at 64 KB
+void writeFile(const std::string& filePath, const std::string& blob)
 {
   std::ofstream outFile(filePath);
   if (!outFile)
   {
-		printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", filePath.data());
-		exit(-1);
+    printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", filePath.data());
+    exit(-1);
   }
-  for (auto i : texts)
+  outFile << "// generated by lib/embedFiles\n";
+  outFile << "alignas(8) const unsigned char embeddedBlob[] = {";
+  for (size_t i = 0; i < blob.size(); i++)
   {
-    outFile << "const std::string ";
-    outFile << i.first;
-    outFile << " = \"";
-    outFile << i.second, false;
-    outFile << "\";\n";
+    if (i % 32 == 0)
+      outFile << "\n";
+    outFile << static_cast<unsigned int>(static_cast<unsigned char>(blob[i])) << ",";
   }
+  outFile << "\n};\n";
+  outFile << "const size_t embeddedBlobSize = sizeof(embeddedBlob);\n";
 
   outFile.close();
+  if (!outFile)
+  {
+    printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", filePath.data());
+    exit(-1);
+  }
 }
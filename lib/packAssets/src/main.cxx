@@ -0,0 +1,124 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+
+#include "../../../src/lib/assetPackFormat.hxx"
+
+// Packs every file below the source directories into one asset pack, see
+// src/lib/assetPackFormat.hxx for the layout. Names are relative to the
+// directory they were found in, so they have to be unique across all of them.
+//   packAssets <source directory>... <output file>
+
+std::string readFile(const std::filesystem::path& filePath);
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    printf("Usage: %s <source directory>... <output file>\n", argv[0]);
+    return 1;
+  }
+  std::string outPath = argv[argc - 1];
+
+  // name -> file it comes from
+  std::vector<std::pair<std::string, std::filesystem::path>> files;
+  for (int i = 1; i < argc - 1; i++)
+  {
+    std::filesystem::path sourceDirectory = argv[i];
+    std::error_code error;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(sourceDirectory, error))
+      if (item.is_regular_file())
+        files.emplace_back(std::filesystem::relative(item.path(), sourceDirectory).generic_string(), item.path());
+    if (error)
+    {
+      printf("\033[31mERR:\033[0m Failed to read directory \"%s\"\n", argv[i]);
+      exit(-1);
+    }
+  }
+  // the runtime looks names up with a binary search
+  std::sort(files.begin(), files.end());
+  for (size_t i = 1; i < files.size(); i++)
+  {
+    if (files[i].first == files[i - 1].first)
+    {
+      printf("\033[31mERR:\033[0m \"%s\" is in more than one source directory\n", files[i].first.c_str());
+      exit(-1);
+    }
+  }
+  std::vector<std::string> names;
+  for (const auto& file : files)
+    names.push_back(file.first);
+
+  struct AssetPackHeader header = {};
+  header.magic = ASSET_PACK_MAGIC;
+  header.version = ASSET_PACK_VERSION;
+  header.entryCount = static_cast<uint32_t>(names.size());
+
+  std::vector<struct AssetPackEntry> entries(names.size());
+  std::string nameBlob;
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    entries[i].nameOffset = static_cast<uint32_t>(nameBlob.size());
+    entries[i].nameLength = static_cast<uint32_t>(names[i].size());
+    nameBlob += names[i];
+  }
+  header.nameBytes = static_cast<uint32_t>(nameBlob.size());
+
+  auto align = [](uint64_t offset) { return (offset + ASSET_PACK_ALIGNMENT - 1) & ~(ASSET_PACK_ALIGNMENT - 1); };
+  uint64_t offset = align(sizeof(header) + entries.size() * sizeof(struct AssetPackEntry) + nameBlob.size());
+
+  std::ofstream outFile(outPath, std::ios::binary);
+  if (!outFile)
+  {
+    printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", outPath.data());
+    exit(-1);
+  }
+  // payloads are read one at a time, the index goes in last
+  outFile.seekp(static_cast<std::streamoff>(offset));
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    std::string payload = readFile(files[i].second);
+    entries[i].offset = offset;
+    entries[i].size = payload.size();
+    entries[i].hash = hashBytes(payload.data(), payload.size());
+    outFile.seekp(static_cast<std::streamoff>(offset));
+    outFile.write(payload.data(), payload.size());
+    offset = align(offset + payload.size());
+    printf("  %s, %zu bytes\n", names[i].c_str(), payload.size());
+  }
+
+  outFile.seekp(0);
+  outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  outFile.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(struct AssetPackEntry));
+  outFile.write(nameBlob.data(), nameBlob.size());
+  outFile.close();
+  if (!outFile)
+  {
+    printf("\033[31mERR:\033[0m Failed to write file \"%s\"\n", outPath.data());
+    exit(-1);
+  }
+
+  printf("Packed %zu files into \"%s\"\n", names.size(), outPath.c_str());
+  return 0;
+}
+
+std::string readFile(const std::filesystem::path& filePath)
+{
+  std::ifstream file;
+  file.open(filePath, std::ios::binary);
+  if (!file)
+  {
+    printf("\033[31mERR:\033[0m Failed to open file \"%s\"\n", filePath.string().data());
+    exit(-1);
+  }
+  file.seekg(0, std::ios::end);
+  size_t fileSizeInByte = file.tellg();
+  std::string buffer;
+  buffer.resize(fileSizeInByte);
+  file.seekg(0, std::ios::beg);
+  file.read(&buffer[0], fileSizeInByte);
+  return buffer;
+}
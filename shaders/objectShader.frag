@@ -1,8 +1,11 @@
 #version 450
+#ifdef NON_UNIFORM_TEXTURES
+// built as objectShaderNonUniform.frag, used with descriptor indexing
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
 
 layout(location = 0) in vec3 fragNormal;
-layout(location = 1) in vec3 fragColor;
-layout(location = 2) in vec3 fragMaterialSpecular;
+layout(location = 1) flat in uint fragMaterial;
 layout(location = 3) in vec3 fragViewNormal;//useless
 layout(location = 4) in vec3 fragPosition;
 layout(location = 5) in vec3 fragViewVec;
@@ -12,9 +15,28 @@ layout(location = 8) in vec4 fragLightSpacePos;
 layout(location = 9) in float fragShadowMapResolution;
 layout(location = 10) in float fragBiasFactor;
 
-layout(binding = 1) uniform sampler2D texSampler;
 layout(set = 0, binding = 2) uniform sampler2DShadow shadowMap;
 
+// bindless textures, sized by the app (textureArraySize)
+layout(constant_id = 0) const uint TEXTURE_ARRAY_SIZE = 1;
+layout(set = 1, binding = 0) uniform sampler2D textures[TEXTURE_ARRAY_SIZE];
+
+struct Material {
+  vec4 diffuse;
+  vec4 specular; // a = shininess
+  uint textureIndex; // map_Kd, NO_TEXTURE when there is none
+};
+
+// every model's materials, see createMaterialBuffer
+layout(std430, set = 1, binding = 1) readonly buffer Materials {
+  Material materials[];
+};
+
+layout(push_constant) uniform DrawConstants {
+  uint textureIndex; // NO_TEXTURE (0xFFFFFFFF) or anything past the array: material color only
+  uint firstMaterial;
+} draw;
+
 layout(location = 0) out vec4 outColor;
 
 void main()
@@ -25,11 +47,19 @@ void main()
   vec3 lightVec = normalize(fragLightDir);
   vec3 halfVec = normalize(lightVec + viewVec);
 
-  float shininess = 16.0f;
+  Material material = materials[draw.firstMaterial + fragMaterial];
   vec3 sunIntensity = vec3(1.5f);
 
-  vec3 diffuseLight = fragColor * sunIntensity * vec3(0.96f, 0.86f, 0.61f) * max(dot(norm, lightVec), 0.0f) * vec3(1.0f);
-  vec3 specularLight = fragMaterialSpecular * sunIntensity * pow(max(dot(norm, halfVec), 0.0f), shininess) * vec3(1.0f);
+  vec3 albedo = material.diffuse.rgb;
+  if (draw.textureIndex < TEXTURE_ARRAY_SIZE)
+    albedo *= texture(textures[draw.textureIndex], fragTexCoord).rgb;
+#ifdef NON_UNIFORM_TEXTURES
+  if (material.textureIndex < TEXTURE_ARRAY_SIZE)
+    albedo *= texture(textures[nonuniformEXT(material.textureIndex)], fragTexCoord).rgb;
+#endif
+
+  vec3 diffuseLight = albedo * sunIntensity * vec3(0.96f, 0.86f, 0.61f) * max(dot(norm, lightVec), 0.0f) * vec3(1.0f);
+  vec3 specularLight = material.specular.rgb * sunIntensity * pow(max(dot(norm, halfVec), 0.0f), material.specular.a) * vec3(1.0f);
 
   // shadow map utilization
   float bias = 0.01f * fragBiasFactor;
@@ -44,7 +74,7 @@ void main()
   }
   shadow /= 25.0f;
 
-  vec3 ambientLight = fragColor * vec3(0.63, 0.76, 1.0f) * vec3(0.25f);
+  vec3 ambientLight = albedo * vec3(0.63, 0.76, 1.0f) * vec3(0.25f);
 
   outColor = vec4(( ( (diffuseLight * 0.7f) + (specularLight * 0.7f) ) * shadow) + ambientLight, 1.0f);
 }
@@ -1,13 +1,12 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
+layout(location = 0) in vec3 inPosition; // unorm16 relative to the bounds when quantized, ubo.model undoes it
+layout(location = 1) in uint inMaterial;
+layout(location = 2) in vec2 inNormal; // octahedral
 layout(location = 3) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 fragNormal;
-layout(location = 1) out vec3 fragColor;
-layout(location = 2) out vec3 fragMaterialSpecular;
+layout(location = 1) flat out uint fragMaterial; // relative to draw.firstMaterial
 layout(location = 3) out vec3 fragViewNormal;
 layout(location = 4) out vec3 fragPosition;
 layout(location = 5) out vec3 fragViewVec;
@@ -17,6 +16,10 @@ layout(location = 8) out vec4 fragLightSpacePos;
 layout(location = 9) out float fragShadowMapResolution;
 layout(location = 10) out float fragBiasFactor;
 
+// the depth pre-pass and the EQUAL tested color pass both run this shader,
+// their depths have to come out bit for bit the same
+invariant gl_Position;
+
 layout(binding = 0) uniform SceneUBO { // TODO: create another buffer for fragment shader
 	mat4 model;
 	mat4 view;
@@ -24,13 +27,21 @@ layout(binding = 0) uniform SceneUBO { // TODO: create another buffer for fragme
   mat4 normalMatrix;
   mat4 normalViewMatrix;
   mat4 lightSpaceMatrix;
-  vec3 materialSpecular; 
   vec3 lightDir;
   vec3 viewPos;
   vec3 shadowMapResolution;
   vec3 biasFactor;
 } ubo;
 
+vec3 octahedralDecode(vec2 e)
+{
+  vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0f);
+  n.x += n.x >= 0.0f ? -t : t;
+  n.y += n.y >= 0.0f ? -t : t;
+  return normalize(n);
+}
+
 void main()
 {
   mat4 mvp = ubo.proj * ubo.view * ubo.model;
@@ -50,11 +61,11 @@ void main()
   fragPosition = vec3(ubo.model * vec4(inPosition, 1.0f));
   fragTexCoord = inTexCoord;
 
-  fragColor = inColor;
-  fragMaterialSpecular = ubo.materialSpecular;
+  fragMaterial = inMaterial;
 
-  fragNormal = vec3(ubo.normalMatrix * vec4(inNormal, 0.0f));
+  vec3 normal = octahedralDecode(inNormal);
+  fragNormal = vec3(ubo.normalMatrix * vec4(normal, 0.0f));
   fragViewVec = ubo.viewPos - fragPosition;
 
-  fragViewNormal = vec3(normalize(ubo.normalViewMatrix * vec4(inNormal, 0.0f))); // useless
+  fragViewNormal = vec3(normalize(ubo.normalViewMatrix * vec4(normal, 0.0f))); // useless
 }
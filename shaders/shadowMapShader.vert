@@ -1,8 +1,6 @@
 #version 450
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoord;
 
 layout(binding = 0) uniform ShadowUBO {
   mat4 lightSpaceMatrix;
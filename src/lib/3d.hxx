@@ -1,15 +1,15 @@
-struct Vertex {
-  glm::vec3 pos;
-	glm::vec3 color;
-	glm::vec3 normal;
-  glm::vec2 texCoord;
-
-  bool operator==(const Vertex& other) const {
-      return pos == other.pos && normal == other.normal && texCoord == other.texCoord;
-  }
+#include "meshTypes.hxx"
+
+// index range of one detail level, all levels share the model's vertices
+struct MeshLod {
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  float error; // how far the surface moved from the full mesh, in model units
 };
 
 #include "obj_loader.hxx"
+#include "meshOptimizer.hxx"
+#include "meshSimplify.hxx"
 
 struct Model {
   std::string name = "Unnamed Model";
@@ -20,6 +20,28 @@ struct Model {
   std::vector<struct Vertex> vertices;
   std::vector<uint32_t> indices;
 
+  // what gets uploaded: the vectors above, or the arrays inside the mapped
+  // mesh cache file when the model came from there
+  struct MappedFile meshCacheFile;
+  const struct Vertex* vertexData = NULL;
+  const uint32_t* indexData = NULL;
+  uint32_t vertexCount = 0;
+  uint32_t indexCount = 0;
+  glm::vec3 boundsMin = glm::vec3(0.0f);
+  glm::vec3 boundsMax = glm::vec3(0.0f);
+  // LOD0 is the full mesh, every following one has about half the triangles
+  std::vector<struct MeshLod> lods;
+  // set while the model is parsed on the asset pool, wait before touching the mesh
+  std::shared_future<void> loaded;
+  // 16 bit when the mesh has few enough vertices, decided at upload
+  VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+  // maps the uploaded positions back to model space (identity unless they're quantized)
+  glm::mat4 positionMatrix = glm::mat4(1.0f);
+  // indexed by the vertices' material, first entry is the default one
+  std::vector<struct Material> materials;
+  // where materials start in materialTable, set at upload
+  uint32_t firstMaterial = 0;
+
   VkBuffer vertexBuffer;
   VkDeviceMemory vertexBufferMemory;
 
@@ -29,56 +51,60 @@ struct Model {
 
 std::unordered_map<std::string, struct Model> Models;
 
-struct GameObject {
-  bool isBad = false;
-  bool isScored = false;
-  std::string name = "Unnamed Object";
+#include "meshCache.hxx"
 
-  std::string modelName = "Unnamed Model";
+// what the renderer needs of an object's simulation state, see snapshots.hxx
+struct ObjectTransform {
+  glm::vec3 position;
+  glm::vec3 rotation; // degrees
+  glm::vec3 scale;
+};
+
+glm::mat4 transformMatrix(const struct ObjectTransform& transform)
+{
+  glm::mat4 model = glm::mat4(1.0f);
+  model = glm::translate(model, transform.position);
+  model = glm::rotate(model, glm::radians(transform.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+  model = glm::rotate(model, glm::radians(transform.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+  model = glm::rotate(model, glm::radians(transform.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+  model = glm::scale(model, transform.scale);
+  return model;
+}
 
-  glm::vec3 accel = glm::vec3(0.0f);
-  glm::vec3 velocity = glm::vec3(0.0f);
-  glm::vec3 position = glm::vec3(0.0f);
-  glm::vec3 rotationSpeed = glm::vec3(0.0f);
-  glm::vec3 rotation = glm::vec3(0.0f);
-  glm::vec3 scale = glm::vec3(1.0f);
+#include "bodies.hxx"
+#include "entities.hxx"
 
-  std::vector<VkBuffer> shadowMapUniformBuffers;
-  std::vector<VkDeviceMemory> shadowMapUniformBuffersMemory;
-  std::vector<void*> shadowMapUniformBuffersMapped;
+const struct BodyDesc tubesBodyTemplate = {
+  .velocity = glm::vec3(-7.2f, 0.0f, 0.0f),
+  .scale = glm::vec3(1.5f, 1.5f, 1.20f)
+};
 
-  std::vector<VkBuffer> uniformBuffers;
-  std::vector<VkDeviceMemory> uniformBuffersMemory;
-  std::vector<void*> uniformBuffersMapped;
 
-  std::vector<VkDescriptorSet> shadowMapDescriptorSets;
-  std::vector<VkDescriptorSet> descriptorSets;
+void loadModel(struct Model& model)
+{
+  // the mesh cache only stores material indices, the .mtl is always read
+  loadMTL(model.mtlPath, model.materials);
 
-  glm::mat4 getModelMatrix() const
+  uint64_t sourceHash = 0;
+  bool cacheable = MESH_CACHE == 1 && hashMeshSources(model, sourceHash);
+  if (cacheable && loadMeshCache(model, sourceHash))
   {
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::scale(model, scale);
-    return model;
+    printf("Loaded \"%s\" from %s\n", model.objPath.c_str(), meshCachePath(model).c_str());
+    return;
   }
-};
 
-std::vector<struct GameObject> gameObjects;
-std::queue<struct GameObject> spawnQueue;
-std::queue<struct GameObject> despawnQueue;
-
-const struct GameObject tubesTemplate = {
-  .isBad = true,
-  .name = "Pair of Tubes",
-  .modelName = "Tubes Model",
-  .velocity = glm::vec3(-0.015f, 0.0f, 0.0f),
-  .scale = glm::vec3(1.5f, 1.5f, 1.20f)
-};
+  LoadOBJ(model.objPath, model.materials, model.vertices, model.indices);
+  if (OPTIMIZE_MESHES == 1)
+    optimizeMesh(model.name, model.vertices, model.indices);
+  buildMeshLods(model.name, model.vertices, model.indices, model.lods);
+  computeModelBounds(model);
+  useParsedMesh(model);
 
+  if (cacheable)
+    writeMeshCache(model, sourceHash);
+}
 
+// starts loading all models in the background, see Model::loaded
 void loadModels()
 {
   struct Model flappyBirdModel;
@@ -99,14 +125,12 @@ void loadModels()
   terrainModel.mtlPath = "obj/terrain.mtl";
   Models[terrainModel.name] = terrainModel;
 
+  // every model is its own task, the map doesn't change anymore so the
+  // references stay valid while the workers fill them in
   for (auto& model : Models)
   {
-    LoadOBJ(
-        model.second.objPath,
-        model.second.mtlPath,
-        model.second.vertices,
-        model.second.indices
-      );
+    struct Model* target = &model.second;
+    model.second.loaded = assetPool.submit([target]() { loadModel(*target); });
   }
 }
 
@@ -114,30 +138,37 @@ const float numberOfTubes = 15;
 
 void createObjects()
 {
-  struct GameObject FlappyBird;
-  FlappyBird.name = "FlappyBird";
-  FlappyBird.modelName = "Flappy Bird Model";
-  FlappyBird.position = glm::vec3(0.0f, 0.0f, 10.0f);
-  FlappyBird.rotation.z = 90.0f;
-  FlappyBird.scale = glm::vec3(1.0f);
-  FlappyBird.accel.z = -0.0003f;
-  gameObjects.push_back(FlappyBird);
-
-  struct GameObject Terrain;
-  Terrain.name = "Terrain";
-  Terrain.modelName = "Terrain Model";
-  Terrain.position = glm::vec3(0.0f, 0.0f, 0.0f);
-  Terrain.scale = glm::vec3(100.0f, 10.0f, 1.0f);
-  gameObjects.push_back(Terrain);
+  struct BodyDesc flappyBirdBody;
+  flappyBirdBody.position = glm::vec3(0.0f, 0.0f, 10.0f);
+  flappyBirdBody.rotation.z = 90.0f;
+  flappyBirdBody.scale = glm::vec3(1.0f);
+  flappyBirdBody.accel.z = -69.12f;
+  flappyBird = createEntity(flappyBirdBody);
+  struct Renderable flappyBirdRenderable;
+  flappyBirdRenderable.model = &Models["Flappy Bird Model"];
+  addComponent(renderables, flappyBird, flappyBirdRenderable);
+
+  struct BodyDesc terrainBody;
+  terrainBody.position = glm::vec3(0.0f, 0.0f, 0.0f);
+  terrainBody.scale = glm::vec3(100.0f, 10.0f, 1.0f);
+  Entity terrain = createEntity(terrainBody);
+  struct Renderable terrainRenderable;
+  terrainRenderable.model = &Models["Terrain Model"];
+  addComponent(renderables, terrain, terrainRenderable);
 
   for (int i = 0; i < numberOfTubes; i++)
   {
-    struct GameObject tubes = tubesTemplate;
-    tubes.position = glm::vec3(
+    struct BodyDesc tubesBody = tubesBodyTemplate;
+    tubesBody.position = glm::vec3(
         30.0f + static_cast<float>(i) * (200.0f / numberOfTubes),
         0.0f,
         6.0f + 10.5f * 0.01f * static_cast<float>(rand() % 100));
-    gameObjects.push_back(tubes);
+    Entity tubes = createEntity(tubesBody);
+    struct Renderable tubesRenderable;
+    tubesRenderable.model = &Models["Tubes Model"];
+    addComponent(renderables, tubes, tubesRenderable);
+    addComponent(colliders, tubes, Collider());
+    addComponent(scorables, tubes, Scorable());
   }
 
   //LoadOBJ("obj/suzanne.obj", m.vertices, m.indices);
@@ -146,11 +177,125 @@ void createObjects()
 }
 
 
+// GPU vertex layout. The loader, dedup and mesh cache all work on the float
+// Vertex above, vertices only get packed into this while being copied into
+// the staging buffer. The material index is relative to the model's
+// Model::firstMaterial, normals are octahedral encoded in both layouts.
+#if COMPACT_VERTICES == 1
+// 16 bytes: position as unorm16 relative to the model bounds (dequantized by
+// Model::positionMatrix), material index in the 4th position component
+struct GpuVertex {
+  uint16_t pos[3];
+  uint16_t material;
+  int16_t normal[2];
+  uint16_t texCoord[2];
+};
+#else
+// 32 bytes, same attributes in full precision
+struct GpuVertex {
+  float pos[3];
+  uint32_t material;
+  float normal[2];
+  float texCoord[2];
+};
+#endif
+
+glm::vec2 octahedralEncode(glm::vec3 n)
+{
+  float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+  // missing normals decode to +z
+  if (sum == 0.0f)
+    return glm::vec2(0.0f);
+  n /= sum;
+  glm::vec2 p = glm::vec2(n.x, n.y);
+  if (n.z < 0.0f)
+  {
+    p = glm::vec2(
+        (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+  }
+  return p;
+}
+
+static inline uint16_t quantizeUnorm16(float value)
+{
+  return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+static inline int16_t quantizeSnorm16(float value)
+{
+  return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Sets positionMatrix. Has to run before packModelVertices.
+void prepareModelVertexFormat(struct Model& model)
+{
+#if COMPACT_VERTICES == 1
+  // flat meshes have a zero extent on one axis, anything non zero works there
+  glm::vec3 extent = model.boundsMax - model.boundsMin;
+  for (int i = 0; i < 3; i++)
+    if (extent[i] <= 0.0f) extent[i] = 1.0f;
+  model.positionMatrix = glm::scale(glm::translate(glm::mat4(1.0f), model.boundsMin), extent);
+
+  bool uvOutOfRange = false;
+  for (uint32_t i = 0; i < model.vertexCount && !uvOutOfRange; i++)
+  {
+    const glm::vec2& uv = model.vertexData[i].texCoord;
+    uvOutOfRange = uv.x < 0.0f || uv.x > 1.0f || uv.y < 0.0f || uv.y > 1.0f;
+  }
+  if (uvOutOfRange)
+    std::cout << "WARN: \"" << model.name << "\" has UVs outside [0, 1], they are clamped (set COMPACT_VERTICES 0 for wrapping UVs)\n";
+#else
+  model.positionMatrix = glm::mat4(1.0f);
+#endif
+}
+
+// vertices first..first+count-1, uploads pack them chunk by chunk
+void packModelVertices(const struct Model& model, uint32_t first, uint32_t count, struct GpuVertex* out)
+{
+#if COMPACT_VERTICES == 1
+  glm::vec3 extent = model.boundsMax - model.boundsMin;
+  glm::vec3 invExtent;
+  for (int i = 0; i < 3; i++)
+    invExtent[i] = extent[i] > 0.0f ? 1.0f / extent[i] : 0.0f;
+#endif
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const struct Vertex& v = model.vertexData[first + i];
+    struct GpuVertex packed;
+
+    uint32_t material = v.material < model.materials.size() ? v.material : 0;
+    glm::vec2 normal = octahedralEncode(v.normal);
+
+#if COMPACT_VERTICES == 1
+    glm::vec3 pos = (v.pos - model.boundsMin) * invExtent;
+    for (int c = 0; c < 3; c++)
+      packed.pos[c] = quantizeUnorm16(pos[c]);
+    packed.material = static_cast<uint16_t>(material);
+    packed.normal[0] = quantizeSnorm16(normal.x);
+    packed.normal[1] = quantizeSnorm16(normal.y);
+    packed.texCoord[0] = quantizeUnorm16(v.texCoord.x);
+    packed.texCoord[1] = quantizeUnorm16(v.texCoord.y);
+#else
+    packed.pos[0] = v.pos.x;
+    packed.pos[1] = v.pos.y;
+    packed.pos[2] = v.pos.z;
+    packed.material = material;
+    packed.normal[0] = normal.x;
+    packed.normal[1] = normal.y;
+    packed.texCoord[0] = v.texCoord.x;
+    packed.texCoord[1] = v.texCoord.y;
+#endif
+    out[i] = packed;
+  }
+}
+
 static VkVertexInputBindingDescription getBindingDescription()
 {
 	VkVertexInputBindingDescription bindingDescription = {};
 	bindingDescription.binding = 0;
-	bindingDescription.stride = sizeof(struct Vertex);
+	bindingDescription.stride = sizeof(struct GpuVertex);
 	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 	return bindingDescription;
 }
@@ -160,25 +305,29 @@ const uint32_t attributeDescriptionCount = 4;
 static VkVertexInputAttributeDescription* getAttributeDescriptions()
 {
 	VkVertexInputAttributeDescription* attributeDescriptions = new VkVertexInputAttributeDescription[4]{};
-	// vec3 inPosition
-	attributeDescriptions[0].binding = 0;
-	attributeDescriptions[0].location = 0;
-	attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[0].offset = offsetof(struct Vertex, pos);
-	// vec3 inColor
-	attributeDescriptions[1].binding = 0;
-	attributeDescriptions[1].location = 1;
-	attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[1].offset = offsetof(struct Vertex, color);
-	// vec3 inNormal
-	attributeDescriptions[2].binding = 0;
-	attributeDescriptions[2].location = 2;
-	attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-	attributeDescriptions[2].offset = offsetof(struct Vertex, normal);
+#if COMPACT_VERTICES == 1
+	// vec3 inPosition, the 4th component is the material and gets dropped
+	attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+	// uint inMaterial
+	attributeDescriptions[1].format = VK_FORMAT_R16_UINT;
+	// vec2 inNormal, octahedral
+	attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
   // vec2 inTexCoord
-	attributeDescriptions[3].binding = 0;
-	attributeDescriptions[3].location = 3;
+	attributeDescriptions[3].format = VK_FORMAT_R16G16_UNORM;
+#else
+	attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+	attributeDescriptions[1].format = VK_FORMAT_R32_UINT;
+	attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
 	attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
-	attributeDescriptions[3].offset = offsetof(struct Vertex, texCoord);
+#endif
+	attributeDescriptions[0].offset = offsetof(struct GpuVertex, pos);
+	attributeDescriptions[1].offset = offsetof(struct GpuVertex, material);
+	attributeDescriptions[2].offset = offsetof(struct GpuVertex, normal);
+	attributeDescriptions[3].offset = offsetof(struct GpuVertex, texCoord);
+	for (uint32_t i = 0; i < attributeDescriptionCount; i++)
+	{
+		attributeDescriptions[i].binding = 0;
+		attributeDescriptions[i].location = i;
+	}
 	return attributeDescriptions;
 }
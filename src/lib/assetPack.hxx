@@ -0,0 +1,129 @@
+#include "assetPackFormat.hxx"
+#include "embeddedAssets.hxx"
+
+// Runtime side of the asset pack. build.sh packs static/ into one
+// ASSET_PACK_FILE next to the binary, which gets mapped once at startup;
+// every asset is then a view into that mapping instead of its own file
+// open. Without a pack the files embedded in the binary are used, and
+// without those (EMBEDDED_ASSETS 0) the loose files in static/.
+
+struct AssetPack {
+  struct MappedFile file;
+  const struct AssetPackEntry* entries = NULL;
+  const char* names = NULL;
+  uint32_t entryCount = 0;
+};
+
+struct AssetPack assetPack;
+
+bool openAssetPack(const std::string& path)
+{
+  struct MappedFile file;
+  if (!mapFile(path, file))
+    return false;
+
+  struct AssetPackHeader header;
+  bool valid = file.size >= sizeof(header);
+  if (valid)
+  {
+    memcpy(&header, file.data, sizeof(header));
+    uint64_t namesOffset = sizeof(header) + static_cast<uint64_t>(header.entryCount) * sizeof(struct AssetPackEntry);
+    valid = header.magic == ASSET_PACK_MAGIC &&
+      header.version == ASSET_PACK_VERSION &&
+      namesOffset + header.nameBytes <= file.size;
+    for (uint32_t i = 0; valid && i < header.entryCount; i++)
+    {
+      const struct AssetPackEntry* entry = reinterpret_cast<const struct AssetPackEntry*>(file.data + sizeof(header)) + i;
+      valid = static_cast<uint64_t>(entry->nameOffset) + entry->nameLength <= header.nameBytes &&
+        entry->offset % ASSET_PACK_ALIGNMENT == 0 &&
+        entry->offset + entry->size <= file.size;
+    }
+  }
+  if (!valid)
+  {
+    printf("\033[33mWARN:\033[0m \"%s\" isn't a valid asset pack, using loose files\n", path.c_str());
+    unmapFile(file);
+    return false;
+  }
+
+#ifndef IS_WINDOWS
+  // the whole pack gets used during startup, read it ahead in one go
+  madvise(const_cast<char*>(file.data), file.size, MADV_WILLNEED);
+#endif
+  assetPack.file = file;
+  assetPack.entries = reinterpret_cast<const struct AssetPackEntry*>(file.data + sizeof(header));
+  assetPack.names = file.data + sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(struct AssetPackEntry);
+  assetPack.entryCount = header.entryCount;
+  printf("Mapped asset pack \"%s\", %u assets, %.2f MB\n", path.c_str(), header.entryCount,
+      static_cast<double>(file.size) / (1024.0 * 1024.0));
+  return true;
+}
+
+const struct AssetPackEntry* findAsset(const std::string& name)
+{
+  return findEntry(assetPack.entries, assetPack.entryCount, assetPack.names, name);
+}
+
+// path is relative to static/, e.g. "obj/tubes.obj"
+bool openAsset(const std::string& path, struct MappedFile& file)
+{
+  const struct AssetPackEntry* entry = findAsset(path);
+  if (entry != NULL)
+  {
+    file = MappedFile();
+    file.data = entry->size > 0 ? assetPack.file.data + entry->offset : NULL;
+    file.size = static_cast<size_t>(entry->size);
+    file.borrowed = true;
+    return true;
+  }
+
+  const struct EmbeddedEntry* embedded = findEmbeddedAsset(path);
+  if (embedded != NULL)
+  {
+    file = MappedFile();
+    file.data = unpackEmbeddedAsset(*embedded);
+    file.size = static_cast<size_t>(embedded->size);
+    file.borrowed = true;
+    return true;
+  }
+  return mapFile("static/" + path, file);
+}
+
+// content hash and size, packed and embedded assets have it in the index and aren't read
+bool hashAsset(const std::string& path, uint64_t& hash, uint64_t& size)
+{
+  const struct AssetPackEntry* entry = findAsset(path);
+  if (entry != NULL)
+  {
+    hash = entry->hash;
+    size = entry->size;
+    return true;
+  }
+  const struct EmbeddedEntry* embedded = findEmbeddedAsset(path);
+  if (embedded != NULL)
+  {
+    hash = embedded->hash;
+    size = embedded->size;
+    return true;
+  }
+
+  struct MappedFile file;
+  if (!mapFile("static/" + path, file))
+    return false;
+  hash = hashBytes(file.data, file.size);
+  size = file.size;
+  unmapFile(file);
+  return true;
+}
+
+// read from static/, not from the pack or the binary
+bool isLooseAsset(const std::string& path)
+{
+  return findAsset(path) == NULL && findEmbeddedAsset(path) == NULL;
+}
+
+void closeAssetPack()
+{
+  unmapFile(assetPack.file);
+  assetPack = AssetPack();
+}
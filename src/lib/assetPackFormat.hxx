@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// Asset pack layout, shared by the runtime reader (assetPack.hxx) and the
+// offline packer (lib/packAssets):
+//   AssetPackHeader
+//   AssetPackEntry[entryCount], sorted by name
+//   names, not null terminated, entries point into them
+//   payloads, each starting on an ASSET_PACK_ALIGNMENT boundary
+// Names are the paths below static/ with forward slashes ("obj/tubes.obj").
+
+const uint32_t ASSET_PACK_MAGIC = 0x50424656; // "VFBP"
+const uint32_t ASSET_PACK_VERSION = 1;
+// page size, every payload can be mapped or handed out on its own pages
+const uint64_t ASSET_PACK_ALIGNMENT = 4096;
+
+struct AssetPackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entryCount;
+  uint32_t nameBytes;
+};
+
+struct AssetPackEntry {
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t hash; // hashBytes of the payload
+};
+
+// The blob lib/embedFiles links into the binary (embededFiles.hxx) is laid
+// out the same way with EMBEDDED_BLOB_MAGIC, except that entries are
+// EmbeddedEntry and payloads are LZ4 blocks (lz4.hxx) packed back to back.
+// A payload that doesn't get smaller is stored as is, packedSize == size.
+const uint32_t EMBEDDED_BLOB_MAGIC = 0x42454656; // "VFEB"
+const uint32_t EMBEDDED_BLOB_VERSION = 1;
+
+struct EmbeddedEntry {
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint64_t offset;
+  uint64_t packedSize;
+  uint64_t size; // once decompressed
+  uint64_t hash; // hashBytes of the decompressed payload
+};
+
+// entries are sorted by name, so a binary search
+template <typename Entry>
+const Entry* findEntry(const Entry* entries, uint32_t entryCount, const char* names, const std::string& name)
+{
+  uint32_t low = 0;
+  uint32_t high = entryCount;
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+    const Entry& entry = entries[middle];
+    int order = name.compare(0, std::string::npos, names + entry.nameOffset, entry.nameLength);
+    if (order == 0)
+      return &entry;
+    if (order < 0)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+  return NULL;
+}
+
+// FNV-1a, the sources are small and read once per launch
+uint64_t hashBytes(const char* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
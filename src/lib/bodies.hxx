@@ -0,0 +1,101 @@
+#if defined(__AVX__)
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+#endif
+
+// Simulated state of every object, one array per quantity and axis instead
+// of one struct per object: an entity's ID indexes into all of them. The
+// integration step is then the same "value += rate * step" over pairs of
+// contiguous float arrays, which the kernel below does 8 (AVX) or 4 (SSE,
+// NEON) objects at a time. All rates are per second.
+
+struct Bodies {
+  uint32_t count = 0;
+  std::vector<float> positionX, positionY, positionZ;
+  std::vector<float> velocityX, velocityY, velocityZ;
+  std::vector<float> accelX, accelY, accelZ;
+  std::vector<float> rotationX, rotationY, rotationZ; // degrees
+  std::vector<float> rotationSpeedX, rotationSpeedY, rotationSpeedZ;
+  std::vector<float> scaleX, scaleY, scaleZ;
+  // moved instead of simulated this tick, frames shouldn't blend over the jump
+  std::vector<uint8_t> teleported;
+};
+
+struct Bodies bodies;
+
+// what an object starts with, only used to create its body
+struct BodyDesc {
+  glm::vec3 position = glm::vec3(0.0f);
+  glm::vec3 velocity = glm::vec3(0.0f);
+  glm::vec3 accel = glm::vec3(0.0f);
+  glm::vec3 rotation = glm::vec3(0.0f);
+  glm::vec3 rotationSpeed = glm::vec3(0.0f);
+  glm::vec3 scale = glm::vec3(1.0f);
+};
+
+void pushVec3(std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, const glm::vec3& value)
+{
+  x.push_back(value.x);
+  y.push_back(value.y);
+  z.push_back(value.z);
+}
+
+uint32_t addBody(const struct BodyDesc& desc)
+{
+  pushVec3(bodies.positionX, bodies.positionY, bodies.positionZ, desc.position);
+  pushVec3(bodies.velocityX, bodies.velocityY, bodies.velocityZ, desc.velocity);
+  pushVec3(bodies.accelX, bodies.accelY, bodies.accelZ, desc.accel);
+  pushVec3(bodies.rotationX, bodies.rotationY, bodies.rotationZ, desc.rotation);
+  pushVec3(bodies.rotationSpeedX, bodies.rotationSpeedY, bodies.rotationSpeedZ, desc.rotationSpeed);
+  pushVec3(bodies.scaleX, bodies.scaleY, bodies.scaleZ, desc.scale);
+  bodies.teleported.push_back(true);
+  return bodies.count++;
+}
+
+struct ObjectTransform bodyTransform(uint32_t body)
+{
+  struct ObjectTransform transform;
+  transform.position = glm::vec3(bodies.positionX[body], bodies.positionY[body], bodies.positionZ[body]);
+  transform.rotation = glm::vec3(bodies.rotationX[body], bodies.rotationY[body], bodies.rotationZ[body]);
+  transform.scale = glm::vec3(bodies.scaleX[body], bodies.scaleY[body], bodies.scaleZ[body]);
+  return transform;
+}
+
+// value[i] += rate[i] * step for all bodies
+void integrateArray(float* value, const float* rate, uint32_t count, float step)
+{
+  uint32_t i = 0;
+#if defined(__AVX__)
+  __m256 steps = _mm256_set1_ps(step);
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(value + i, _mm256_add_ps(_mm256_loadu_ps(value + i), _mm256_mul_ps(_mm256_loadu_ps(rate + i), steps)));
+#elif defined(__SSE2__) || defined(_M_X64)
+  __m128 steps = _mm_set1_ps(step);
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(value + i), _mm_mul_ps(_mm_loadu_ps(rate + i), steps)));
+#elif defined(__ARM_NEON)
+  float32x4_t steps = vdupq_n_f32(step);
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(value + i, vmlaq_f32(vld1q_f32(value + i), vld1q_f32(rate + i), steps));
+#endif
+  for (; i < count; i++)
+    value[i] += rate[i] * step;
+}
+
+// semi-implicit Euler, velocity first and position moves by the new one
+void integrateBodies(float step)
+{
+  uint32_t count = bodies.count;
+  integrateArray(bodies.rotationX.data(), bodies.rotationSpeedX.data(), count, step);
+  integrateArray(bodies.rotationY.data(), bodies.rotationSpeedY.data(), count, step);
+  integrateArray(bodies.rotationZ.data(), bodies.rotationSpeedZ.data(), count, step);
+  integrateArray(bodies.velocityX.data(), bodies.accelX.data(), count, step);
+  integrateArray(bodies.velocityY.data(), bodies.accelY.data(), count, step);
+  integrateArray(bodies.velocityZ.data(), bodies.accelZ.data(), count, step);
+  integrateArray(bodies.positionX.data(), bodies.velocityX.data(), count, step);
+  integrateArray(bodies.positionY.data(), bodies.velocityY.data(), count, step);
+  integrateArray(bodies.positionZ.data(), bodies.velocityZ.data(), count, step);
+}
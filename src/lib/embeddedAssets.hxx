@@ -0,0 +1,109 @@
+#include <mutex>
+#include <memory>
+
+#include "lz4.hxx"
+#include "embededFiles.hxx"
+
+// Runtime side of the blob lib/embedFiles links into the binary: the
+// shaders, and with EMBEDDED_ASSETS static/ and the compiled textures too,
+// so a release is just the executable. An entry is decompressed the first
+// time it's opened, so only the texture variants the device samples take up
+// memory; the shaders are always needed and go to the asset pool right away.
+// The decompressed files stay for the whole run, like the mapped asset pack
+// does.
+
+struct EmbeddedAssets {
+  const struct EmbeddedEntry* entries = NULL;
+  const char* names = NULL;
+  uint32_t entryCount = 0;
+  std::unique_ptr<std::unique_ptr<char[]>[]> unpacked; // per entry, once opened
+  std::unique_ptr<std::once_flag[]> unpackOnce;
+};
+
+struct EmbeddedAssets embeddedAssets;
+
+// shaders are always used, the rest only with EMBEDDED_ASSETS
+bool isEmbeddedShader(const struct EmbeddedEntry& entry)
+{
+  return std::string(embeddedAssets.names + entry.nameOffset, entry.nameLength).rfind("shaders/", 0) == 0;
+}
+
+const char* unpackEmbeddedAsset(const struct EmbeddedEntry& entry)
+{
+  uint32_t index = static_cast<uint32_t>(&entry - embeddedAssets.entries);
+  std::call_once(embeddedAssets.unpackOnce[index], [&entry, index]() {
+    char* unpacked = new char[std::max<size_t>(static_cast<size_t>(entry.size), 1)];
+    embeddedAssets.unpacked[index].reset(unpacked);
+    const char* packed = reinterpret_cast<const char*>(embeddedBlob) + entry.offset;
+    if (entry.packedSize == entry.size)
+      memcpy(unpacked, packed, entry.size);
+    else if (!lz4Decompress(packed, entry.packedSize, unpacked, entry.size))
+    {
+      printf("\033[31mERR:\033[0m Embedded file \"%.*s\" is corrupt\n",
+          static_cast<int>(entry.nameLength), embeddedAssets.names + entry.nameOffset);
+      exit(-1);
+    }
+  });
+  return embeddedAssets.unpacked[index].get();
+}
+
+void openEmbeddedAssets()
+{
+  struct AssetPackHeader header;
+  bool valid = embeddedBlobSize >= sizeof(header);
+  if (valid)
+  {
+    memcpy(&header, embeddedBlob, sizeof(header));
+    uint64_t namesOffset = sizeof(header) + static_cast<uint64_t>(header.entryCount) * sizeof(struct EmbeddedEntry);
+    valid = header.magic == EMBEDDED_BLOB_MAGIC &&
+      header.version == EMBEDDED_BLOB_VERSION &&
+      namesOffset + header.nameBytes <= embeddedBlobSize;
+    for (uint32_t i = 0; valid && i < header.entryCount; i++)
+    {
+      const struct EmbeddedEntry* entry = reinterpret_cast<const struct EmbeddedEntry*>(embeddedBlob + sizeof(header)) + i;
+      valid = static_cast<uint64_t>(entry->nameOffset) + entry->nameLength <= header.nameBytes &&
+        entry->offset + entry->packedSize <= embeddedBlobSize;
+    }
+  }
+  if (!valid)
+  {
+    printf("\033[31mERR:\033[0m The embedded files are from another version, rebuild with lib/embedFiles\n");
+    exit(-1);
+  }
+
+  embeddedAssets.entries = reinterpret_cast<const struct EmbeddedEntry*>(embeddedBlob + sizeof(header));
+  embeddedAssets.names = reinterpret_cast<const char*>(embeddedBlob) + sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(struct EmbeddedEntry);
+  embeddedAssets.entryCount = header.entryCount;
+  embeddedAssets.unpacked.reset(new std::unique_ptr<char[]>[header.entryCount]);
+  embeddedAssets.unpackOnce.reset(new std::once_flag[header.entryCount]);
+
+  // submitted before the model and texture loads, the pool starts on these
+  for (uint32_t i = 0; i < header.entryCount; i++)
+  {
+    const struct EmbeddedEntry* entry = &embeddedAssets.entries[i];
+    if (isEmbeddedShader(*entry))
+      assetPool.submit([entry]() { unpackEmbeddedAsset(*entry); });
+  }
+  printf("Embedded files: %u, %.2f MB\n", header.entryCount,
+      static_cast<double>(embeddedBlobSize) / (1024.0 * 1024.0));
+}
+
+const struct EmbeddedEntry* findEmbeddedAsset(const std::string& name)
+{
+  const struct EmbeddedEntry* entry = findEntry(embeddedAssets.entries, embeddedAssets.entryCount, embeddedAssets.names, name);
+  if (entry == NULL || (EMBEDDED_ASSETS != 1 && !isEmbeddedShader(*entry)))
+    return NULL;
+  return entry;
+}
+
+// for files that are always embedded, e.g. "shaders/objectShader.vert.spv"
+std::string readEmbeddedFile(const std::string& name)
+{
+  const struct EmbeddedEntry* entry = findEmbeddedAsset(name);
+  if (entry == NULL)
+  {
+    printf("\033[31mERR:\033[0m \"%s\" isn't embedded, rebuild with lib/embedFiles\n", name.c_str());
+    exit(-1);
+  }
+  return std::string(unpackEmbeddedAsset(*entry), static_cast<size_t>(entry->size));
+}
@@ -1,4 +0,0 @@
-const std::string shadowMapFragShaderCodeBase64 = "AwIjBwAAAQALAA0ABgAAAAAAAAARAAIAAQAAAAsABgABAAAAR0xTTC5zdGQuNDUwAAAAAA4AAwAAAAAAAQAAAA8ABQAEAAAABAAAAG1haW4AAAAAEAADAAQAAAAHAAAAAwADAAIAAADCAQAABAAKAEdMX0dPT0dMRV9jcHBfc3R5bGVfbGluZV9kaXJlY3RpdmUAAAQACABHTF9HT09HTEVfaW5jbHVkZV9kaXJlY3RpdmUABQAEAAQAAABtYWluAAAAABMAAgACAAAAIQADAAMAAAACAAAANgAFAAIAAAAEAAAAAAAAAAMAAAD4AAIABQAAAP0AAQA4AAEA";
-const std::string objectVertShaderCodeBase64 = "AwIjBwAAAQALAA0ApAAAAAAAAAARAAIAAQAAAAsABgABAAAAR0xTTC5zdGQuNDUwAAAAAA4AAwAAAAAAAQAAAA8AFQAAAAAABAAAAG1haW4AAAAAIQAAACQAAABVAAAAWgAAAF4AAABhAAAAZgAAAHQAAAB2AAAAeAAAAHkAAAB7AAAAfwAAAIMAAACPAAAAlQAAAAMAAwACAAAAwgEAAAQACgBHTF9HT09HTEVfY3BwX3N0eWxlX2xpbmVfZGlyZWN0aXZlAAAEAAgAR0xfR09PR0xFX2luY2x1ZGVfZGlyZWN0aXZlAAUABAAEAAAAbWFpbgAAAAAFAAMACgAAAG12cAAFAAUADAAAAFNjZW5lVUJPAAAAAAYABQAMAAAAAAAAAG1vZGVsAAAABgAFAAwAAAABAAAAdmlldwAAAAAGAAUADAAAAAIAAABwcm9qAAAAAAYABwAMAAAAAwAAAG5vcm1hbE1hdHJpeAAAAAAGAAgADAAAAAQAAABub3JtYWxWaWV3TWF0cml4AAAAAAYACAAMAAAABQAAAGxpZ2h0U3BhY2VNYXRyaXgAAAAABgAIAAwAAAAGAAAAbWF0ZXJpYWxTcGVjdWxhcgAAAAAGAAYADAAAAAcAAABsaWdodERpcgAAAAAGAAUADAAAAAgAAAB2aWV3UG9zAAYACAAMAAAACQAAAHNoYWRvd01hcFJlc29sdXRpb24ABgAGAAwAAAAKAAAAYmlhc0ZhY3RvcgAABQADAA4AAAB1Ym8ABQAGAB8AAABnbF9QZXJWZXJ0ZXgAAAAABgAGAB8AAAAAAAAAZ2xfUG9zaXRpb24ABgAHAB8AAAABAAAAZ2xfUG9pbnRTaXplAAAAAAYABwAfAAAAAgAAAGdsX0NsaXBEaXN0YW5jZQAGAAcAHwAAAAMAAABnbF9DdWxsRGlzdGFuY2UABQADACEAAAAAAAAABQAFACQAAABpblBvc2l0aW9uAAAFAAYALwAAAGxpZ2h0U3BhY2VQb3MAAAAFAAgAVQAAAGZyYWdTaGFkb3dNYXBSZXNvbHV0aW9uAAUABgBaAAAAZnJhZ0JpYXNGYWN0b3IAAAUABwBeAAAAZnJhZ0xpZ2h0U3BhY2VQb3MAAAAFAAYAYQAAAGZyYWdMaWdodERpcgAAAAAFAAYAZgAAAGZyYWdQb3NpdGlvbgAAAAAFAAYAdAAAAGZyYWdUZXhDb29yZAAAAAAFAAUAdgAAAGluVGV4Q29vcmQAAAUABQB4AAAAZnJhZ0NvbG9yAAAABQAEAHkAAABpbkNvbG9yAAUACAB7AAAAZnJhZ01hdGVyaWFsU3BlY3VsYXIAAAAABQAFAH8AAABmcmFnTm9ybWFsAAAFAAUAgwAAAGluTm9ybWFsAAAAAAUABQCPAAAAZnJhZ1ZpZXdWZWMABQAGAJUAAABmcmFnVmlld05vcm1hbAAARwADAAwAAAACAAAASAAEAAwAAAAAAAAABQAAAEgABQAMAAAAAAAAAAcAAAAQAAAASAAFAAwAAAAAAAAAIwAAAAAAAABIAAQADAAAAAEAAAAFAAAASAAFAAwAAAABAAAABwAAABAAAABIAAUADAAAAAEAAAAjAAAAQAAAAEgABAAMAAAAAgAAAAUAAABIAAUADAAAAAIAAAAHAAAAEAAAAEgABQAMAAAAAgAAACMAAACAAAAASAAEAAwAAAADAAAABQAAAEgABQAMAAAAAwAAAAcAAAAQAAAASAAFAAwAAAADAAAAIwAAAMAAAABIAAQADAAAAAQAAAAFAAAASAAFAAwAAAAEAAAABwAAABAAAABIAAUADAAAAAQAAAAjAAAAAAEAAEgABAAMAAAABQAAAAUAAABIAAUADAAAAAUAAAAHAAAAEAAAAEgABQAMAAAABQAAACMAAABAAQAASAAFAAwAAAAGAAAAIwAAAIABAABIAAUADAAAAAcAAAAjAAAAkAEAAEgABQAMAAAACAAAACMAAACgAQAASAAFAAwAAAAJAAAAIwAAALABAABIAAUADAAAAAoAAAAjAAAAwAEAAEcABAAOAAAAIQAAAAAAAABHAAQADgAAACIAAAAAAAAARwADAB8AAAACAAAASAAFAB8AAAAAAAAACwAAAAAAAABIAAUAHwAAAAEAAAALAAAAAQAAAEgABQAfAAAAAgAAAAsAAAADAAAASAAFAB8AAAADAAAACwAAAAQAAABHAAQAJAAAAB4AAAAAAAAARwAEAFUAAAAeAAAACQAAAEcABABaAAAAHgAAAAoAAABHAAQAXgAAAB4AAAAIAAAARwAEAGEAAAAeAAAABwAAAEcABABmAAAAHgAAAAQAAABHAAQAdAAAAB4AAAAGAAAARwAEAHYAAAAeAAAAAwAAAEcABAB4AAAAHgAAAAEAAABHAAQAeQAAAB4AAAABAAAARwAEAHsAAAAeAAAAAgAAAEcABAB/AAAAHgAAAAAAAABHAAQAgwAAAB4AAAACAAAARwAEAI8AAAAeAAAABQAAAEcABACVAAAAHgAAAAMAAAATAAIAAgAAACEAAwADAAAAAgAAABYAAwAGAAAAIAAAABcABAAHAAAABgAAAAQAAAAYAAQACAAAAAcAAAAEAAAAIAAEAAkAAAAHAAAACAAAABcABAALAAAABgAAAAMAAAAeAA0ADAAAAAgAAAAIAAAACAAAAAgAAAAIAAAACAAAAAsAAAALAAAACwAAAAsAAAALAAAAIAAEAA0AAAACAAAADAAAADsABAANAAAADgAAAAIAAAAVAAQADwAAACAAAAABAAAAKwAEAA8AAAAQAAAAAgAAACAABAARAAAAAgAAAAgAAAArAAQADwAAABQAAAABAAAAKwAEAA8AAAAYAAAAAAAAABUABAAcAAAAIAAAAAAAAAArAAQAHAAAAB0AAAABAAAAHAAEAB4AAAAGAAAAHQAAAB4ABgAfAAAABwAAAAYAAAAeAAAAHgAAACAABAAgAAAAAwAAAB8AAAA7AAQAIAAAACEAAAADAAAAIAAEACMAAAABAAAACwAAADsABAAjAAAAJAAAAAEAAAArAAQABgAAACYAAAAAAIA/IAAEACwAAAADAAAABwAAACAABAAuAAAABwAAAAcAAAArAAQADwAAADAAAAAFAAAAKwAEABwAAAA5AAAAAwAAACAABAA6AAAABwAAAAYAAAArAAQAHAAAAEEAAAAAAAAAKwAEABwAAABGAAAAAgAAABcABABJAAAABgAAAAIAAAArAAQABgAAAEwAAAAAAAA/IAAEAFQAAAADAAAABgAAADsABABUAAAAVQAAAAMAAAArAAQADwAAAFYAAAAJAAAAIAAEAFcAAAACAAAABgAAADsABABUAAAAWgAAAAMAAAArAAQADwAAAFsAAAAKAAAAOwAEACwAAABeAAAAAwAAACAABABgAAAAAwAAAAsAAAA7AAQAYAAAAGEAAAADAAAAKwAEAA8AAABiAAAABwAAACAABABjAAAAAgAAAAsAAAA7AAQAYAAAAGYAAAADAAAAIAAEAHMAAAADAAAASQAAADsABABzAAAAdAAAAAMAAAAgAAQAdQAAAAEAAABJAAAAOwAEAHUAAAB2AAAAAQAAADsABABgAAAAeAAAAAMAAAA7AAQAIwAAAHkAAAABAAAAOwAEAGAAAAB7AAAAAwAAACsABAAPAAAAfAAAAAYAAAA7AAQAYAAAAH8AAAADAAAAKwAEAA8AAACAAAAAAwAAADsABAAjAAAAgwAAAAEAAAArAAQABgAAAIUAAAAAAAAAOwAEAGAAAACPAAAAAwAAACsABAAPAAAAkAAAAAgAAAA7AAQAYAAAAJUAAAADAAAAKwAEAA8AAACWAAAABAAAADYABQACAAAABAAAAAAAAAADAAAA+AACAAUAAAA7AAQACQAAAAoAAAAHAAAAOwAEAC4AAAAvAAAABwAAAEEABQARAAAAEgAAAA4AAAAQAAAAPQAEAAgAAAATAAAAEgAAAEEABQARAAAAFQAAAA4AAAAUAAAAPQAEAAgAAAAWAAAAFQAAAJIABQAIAAAAFwAAABMAAAAWAAAAQQAFABEAAAAZAAAADgAAABgAAAA9AAQACAAAABoAAAAZAAAAkgAFAAgAAAAbAAAAFwAAABoAAAA+AAMACgAAABsAAAA9AAQACAAAACIAAAAKAAAAPQAEAAsAAAAlAAAAJAAAAFEABQAGAAAAJwAAACUAAAAAAAAAUQAFAAYAAAAoAAAAJQAAAAEAAABRAAUABgAAACkAAAAlAAAAAgAAAFAABwAHAAAAKgAAACcAAAAoAAAAKQAAACYAAACRAAUABwAAACsAAAAiAAAAKgAAAEEABQAsAAAALQAAACEAAAAYAAAAPgADAC0AAAArAAAAQQAFABEAAAAxAAAADgAAADAAAAA9AAQACAAAADIAAAAxAAAAPQAEAAsAAAAzAAAAJAAAAFEABQAGAAAANAAAADMAAAAAAAAAUQAFAAYAAAA1AAAAMwAAAAEAAABRAAUABgAAADYAAAAzAAAAAgAAAFAABwAHAAAANwAAADQAAAA1AAAANgAAACYAAACRAAUABwAAADgAAAAyAAAANwAAAD4AAwAvAAAAOAAAAEEABQA6AAAAOwAAAC8AAAA5AAAAPQAEAAYAAAA8AAAAOwAAAD0ABAAHAAAAPQAAAC8AAABPAAgACwAAAD4AAAA9AAAAPQAAAAAAAAABAAAAAgAAAFAABgALAAAAPwAAADwAAAA8AAAAPAAAAIgABQALAAAAQAAAAD4AAAA/AAAAQQAFADoAAABCAAAALwAAAEEAAABRAAUABgAAAEMAAABAAAAAAAAAAD4AAwBCAAAAQwAAAEEABQA6AAAARAAAAC8AAAAdAAAAUQAFAAYAAABFAAAAQAAAAAEAAAA+AAMARAAAAEUAAABBAAUAOgAAAEcAAAAvAAAARgAAAFEABQAGAAAASAAAAEAAAAACAAAAPgADAEcAAABIAAAAPQAEAAcAAABKAAAALwAAAE8ABwBJAAAASwAAAEoAAABKAAAAAAAAAAEAAACOAAUASQAAAE0AAABLAAAATAAAAFAABQBJAAAATgAAAEwAAABMAAAAgQAFAEkAAABPAAAATQAAAE4AAABBAAUAOgAAAFAAAAAvAAAAQQAAAFEABQAGAAAAUQAAAE8AAAAAAAAAPgADAFAAAABRAAAAQQAFADoAAABSAAAALwAAAB0AAABRAAUABgAAAFMAAABPAAAAAQAAAD4AAwBSAAAAUwAAAEEABgBXAAAAWAAAAA4AAABWAAAAQQAAAD0ABAAGAAAAWQAAAFgAAAA+AAMAVQAAAFkAAABBAAYAVwAAAFwAAAAOAAAAWwAAAEEAAAA9AAQABgAAAF0AAABcAAAAPgADAFoAAABdAAAAPQAEAAcAAABfAAAALwAAAD4AAwBeAAAAXwAAAEEABQBjAAAAZAAAAA4AAABiAAAAPQAEAAsAAABlAAAAZAAAAD4AAwBhAAAAZQAAAEEABQARAAAAZwAAAA4AAAAYAAAAPQAEAAgAAABoAAAAZwAAAD0ABAALAAAAaQAAACQAAABRAAUABgAAAGoAAABpAAAAAAAAAFEABQAGAAAAawAAAGkAAAABAAAAUQAFAAYAAABsAAAAaQAAAAIAAABQAAcABwAAAG0AAABqAAAAawAAAGwAAAAmAAAAkQAFAAcAAABuAAAAaAAAAG0AAABRAAUABgAAAG8AAABuAAAAAAAAAFEABQAGAAAAcAAAAG4AAAABAAAAUQAFAAYAAABxAAAAbgAAAAIAAABQAAYACwAAAHIAAABvAAAAcAAAAHEAAAA+AAMAZgAAAHIAAAA9AAQASQAAAHcAAAB2AAAAPgADAHQAAAB3AAAAPQAEAAsAAAB6AAAAeQAAAD4AAwB4AAAAegAAAEEABQBjAAAAfQAAAA4AAAB8AAAAPQAEAAsAAAB+AAAAfQAAAD4AAwB7AAAAfgAAAEEABQARAAAAgQAAAA4AAACAAAAAPQAEAAgAAACCAAAAgQAAAD0ABAALAAAAhAAAAIMAAABRAAUABgAAAIYAAACEAAAAAAAAAFEABQAGAAAAhwAAAIQAAAABAAAAUQAFAAYAAACIAAAAhAAAAAIAAABQAAcABwAAAIkAAACGAAAAhwAAAIgAAACFAAAAkQAFAAcAAACKAAAAggAAAIkAAABRAAUABgAAAIsAAACKAAAAAAAAAFEABQAGAAAAjAAAAIoAAAABAAAAUQAFAAYAAACNAAAAigAAAAIAAABQAAYACwAAAI4AAACLAAAAjAAAAI0AAAA+AAMAfwAAAI4AAABBAAUAYwAAAJEAAAAOAAAAkAAAAD0ABAALAAAAkgAAAJEAAAA9AAQACwAAAJMAAABmAAAAgwAFAAsAAACUAAAAkgAAAJMAAAA+AAMAjwAAAJQAAABBAAUAEQAAAJcAAAAOAAAAlgAAAD0ABAAIAAAAmAAAAJcAAAA9AAQACwAAAJkAAACDAAAAUQAFAAYAAACaAAAAmQAAAAAAAABRAAUABgAAAJsAAACZAAAAAQAAAFEABQAGAAAAnAAAAJkAAAACAAAAUAAHAAcAAACdAAAAmgAAAJsAAACcAAAAhQAAAJEABQAHAAAAngAAAJgAAACdAAAADAAGAAcAAACfAAAAAQAAAEUAAACeAAAAUQAFAAYAAACgAAAAnwAAAAAAAABRAAUABgAAAKEAAACfAAAAAQAAAFEABQAGAAAAogAAAJ8AAAACAAAAUAAGAAsAAACjAAAAoAAAAKEAAACiAAAAPgADAJUAAACjAAAA/QABADgAAQA=";
-const std::string shadowMapVertShaderCodeBase64 = "AwIjBwAAAQALAA0AJwAAAAAAAAARAAIAAQAAAAsABgABAAAAR0xTTC5zdGQuNDUwAAAAAA4AAwAAAAAAAQAAAA8ACQAAAAAABAAAAG1haW4AAAAADQAAABkAAAAjAAAAJgAAAAMAAwACAAAAwgEAAAQACgBHTF9HT09HTEVfY3BwX3N0eWxlX2xpbmVfZGlyZWN0aXZlAAAEAAgAR0xfR09PR0xFX2luY2x1ZGVfZGlyZWN0aXZlAAUABAAEAAAAbWFpbgAAAAAFAAYACwAAAGdsX1BlclZlcnRleAAAAAAGAAYACwAAAAAAAABnbF9Qb3NpdGlvbgAGAAcACwAAAAEAAABnbF9Qb2ludFNpemUAAAAABgAHAAsAAAACAAAAZ2xfQ2xpcERpc3RhbmNlAAYABwALAAAAAwAAAGdsX0N1bGxEaXN0YW5jZQAFAAMADQAAAAAAAAAFAAUAEQAAAFNoYWRvd1VCTwAAAAYACAARAAAAAAAAAGxpZ2h0U3BhY2VNYXRyaXgAAAAABQADABMAAAB1Ym8ABQAFABkAAABpblBvc2l0aW9uAAAFAAUAIwAAAGluTm9ybWFsAAAAAAUABQAmAAAAaW5UZXhDb29yZAAARwADAAsAAAACAAAASAAFAAsAAAAAAAAACwAAAAAAAABIAAUACwAAAAEAAAALAAAAAQAAAEgABQALAAAAAgAAAAsAAAADAAAASAAFAAsAAAADAAAACwAAAAQAAABHAAMAEQAAAAIAAABIAAQAEQAAAAAAAAAFAAAASAAFABEAAAAAAAAABwAAABAAAABIAAUAEQAAAAAAAAAjAAAAAAAAAEcABAATAAAAIQAAAAAAAABHAAQAEwAAACIAAAAAAAAARwAEABkAAAAeAAAAAAAAAEcABAAjAAAAHgAAAAEAAABHAAQAJgAAAB4AAAACAAAAEwACAAIAAAAhAAMAAwAAAAIAAAAWAAMABgAAACAAAAAXAAQABwAAAAYAAAAEAAAAFQAEAAgAAAAgAAAAAAAAACsABAAIAAAACQAAAAEAAAAcAAQACgAAAAYAAAAJAAAAHgAGAAsAAAAHAAAABgAAAAoAAAAKAAAAIAAEAAwAAAADAAAACwAAADsABAAMAAAADQAAAAMAAAAVAAQADgAAACAAAAABAAAAKwAEAA4AAAAPAAAAAAAAABgABAAQAAAABwAAAAQAAAAeAAMAEQAAABAAAAAgAAQAEgAAAAIAAAARAAAAOwAEABIAAAATAAAAAgAAACAABAAUAAAAAgAAABAAAAAXAAQAFwAAAAYAAAADAAAAIAAEABgAAAABAAAAFwAAADsABAAYAAAAGQAAAAEAAAArAAQABgAAABsAAAAAAIA/IAAEACEAAAADAAAABwAAADsABAAYAAAAIwAAAAEAAAAXAAQAJAAAAAYAAAACAAAAIAAEACUAAAABAAAAJAAAADsABAAlAAAAJgAAAAEAAAA2AAUAAgAAAAQAAAAAAAAAAwAAAPgAAgAFAAAAQQAFABQAAAAVAAAAEwAAAA8AAAA9AAQAEAAAABYAAAAVAAAAPQAEABcAAAAaAAAAGQAAAFEABQAGAAAAHAAAABoAAAAAAAAAUQAFAAYAAAAdAAAAGgAAAAEAAABRAAUABgAAAB4AAAAaAAAAAgAAAFAABwAHAAAAHwAAABwAAAAdAAAAHgAAABsAAACRAAUABwAAACAAAAAWAAAAHwAAAEEABQAhAAAAIgAAAA0AAAAPAAAAPgADACIAAAAgAAAA/QABADgAAQA=";
-const std::string objectFragShaderCodeBase64 = "AwIjBwAAAQALAA0ArQAAAAAAAAARAAIAAQAAAAsABgABAAAAR0xTTC5zdGQuNDUwAAAAAA4AAwAAAAAAAQAAAA8AEQAEAAAABAAAAG1haW4AAAAACwAAAA8AAAATAAAAIgAAADUAAABEAAAASQAAAHIAAACWAAAApQAAAKYAAACoAAAAEAADAAQAAAAHAAAAAwADAAIAAADCAQAABAAKAEdMX0dPT0dMRV9jcHBfc3R5bGVfbGluZV9kaXJlY3RpdmUAAAQACABHTF9HT09HTEVfaW5jbHVkZV9kaXJlY3RpdmUABQAEAAQAAABtYWluAAAAAAUABAAJAAAAbm9ybQAAAAAFAAUACwAAAGZyYWdOb3JtYWwAAAUABAAOAAAAdmlld1ZlYwAFAAUADwAAAGZyYWdWaWV3VmVjAAUABQASAAAAbGlnaHRWZWMAAAAABQAGABMAAABmcmFnTGlnaHREaXIAAAAABQAEABYAAABoYWxmVmVjAAUABQAcAAAAc2hpbmluZXNzAAAABQAGAB4AAABzdW5JbnRlbnNpdHkAAAAABQAGACEAAABkaWZmdXNlTGlnaHQAAAAABQAFACIAAABmcmFnQ29sb3IAAAAFAAYANAAAAHNwZWN1bGFyTGlnaHQAAAAFAAgANQAAAGZyYWdNYXRlcmlhbFNwZWN1bGFyAAAAAAUABABBAAAAYmlhcwAAAAAFAAYARAAAAGZyYWdCaWFzRmFjdG9yAAAFAAQARwAAAHNoYWRvdwAABQAFAEgAAAB0ZXhlbFNpemUAAAAFAAgASQAAAGZyYWdTaGFkb3dNYXBSZXNvbHV0aW9uAAUAAwBOAAAAeAAAAAUAAwBZAAAAeQAAAAUABABjAAAAb2Zmc2V0AAAFAAUAbgAAAHNoYWRvd01hcAAAAAUABwByAAAAZnJhZ0xpZ2h0U3BhY2VQb3MAAAAFAAYAjAAAAGFtYmllbnRMaWdodAAAAAAFAAUAlgAAAG91dENvbG9yAAAAAAUABgClAAAAZnJhZ1ZpZXdOb3JtYWwAAAUABgCmAAAAZnJhZ1Bvc2l0aW9uAAAAAAUABgCoAAAAZnJhZ1RleENvb3JkAAAAAAUABQCsAAAAdGV4U2FtcGxlcgAARwAEAAsAAAAeAAAAAAAAAEcABAAPAAAAHgAAAAUAAABHAAQAEwAAAB4AAAAHAAAARwAEACIAAAAeAAAAAQAAAEcABAA1AAAAHgAAAAIAAABHAAQARAAAAB4AAAAKAAAARwAEAEkAAAAeAAAACQAAAEcABABuAAAAIQAAAAIAAABHAAQAbgAAACIAAAAAAAAARwAEAHIAAAAeAAAACAAAAEcABACWAAAAHgAAAAAAAABHAAQApQAAAB4AAAADAAAARwAEAKYAAAAeAAAABAAAAEcABACoAAAAHgAAAAYAAABHAAQArAAAACEAAAABAAAARwAEAKwAAAAiAAAAAAAAABMAAgACAAAAIQADAAMAAAACAAAAFgADAAYAAAAgAAAAFwAEAAcAAAAGAAAAAwAAACAABAAIAAAABwAAAAcAAAAgAAQACgAAAAEAAAAHAAAAOwAEAAoAAAALAAAAAQAAADsABAAKAAAADwAAAAEAAAA7AAQACgAAABMAAAABAAAAIAAEABsAAAAHAAAABgAAACsABAAGAAAAHQAAAAAAgEErAAQABgAAAB8AAAAAAMA/LAAGAAcAAAAgAAAAHwAAAB8AAAAfAAAAOwAEAAoAAAAiAAAAAQAAACsABAAGAAAAJgAAAI/CdT8rAAQABgAAACcAAAD2KFw/KwAEAAYAAAAoAAAA9igcPywABgAHAAAAKQAAACYAAAAnAAAAKAAAACsABAAGAAAALgAAAAAAAAArAAQABgAAADEAAAAAAIA/LAAGAAcAAAAyAAAAMQAAADEAAAAxAAAAOwAEAAoAAAA1AAAAAQAAACsABAAGAAAAQgAAAArXIzwgAAQAQwAAAAEAAAAGAAAAOwAEAEMAAABEAAAAAQAAADsABABDAAAASQAAAAEAAAAVAAQATAAAACAAAAABAAAAIAAEAE0AAAAHAAAATAAAACsABABMAAAATwAAAP7///8rAAQATAAAAFYAAAACAAAAFAACAFcAAAAXAAQAYQAAAAYAAAACAAAAIAAEAGIAAAAHAAAAYQAAABkACQBrAAAABgAAAAEAAAABAAAAAAAAAAAAAAABAAAAAAAAABsAAwBsAAAAawAAACAABABtAAAAAAAAAGwAAAA7AAQAbQAAAG4AAAAAAAAAFwAEAHAAAAAGAAAABAAAACAABABxAAAAAQAAAHAAAAA7AAQAcQAAAHIAAAABAAAAFQAEAHcAAAAgAAAAAAAAACsABAB3AAAAeAAAAAIAAAArAAQATAAAAIUAAAABAAAAKwAEAAYAAACJAAAAAADIQSsABAAGAAAAjgAAAK5HIT8rAAQABgAAAI8AAABcj0I/LAAGAAcAAACQAAAAjgAAAI8AAAAxAAAAKwAEAAYAAACSAAAAAACAPiwABgAHAAAAkwAAAJIAAACSAAAAkgAAACAABACVAAAAAwAAAHAAAAA7AAQAlQAAAJYAAAADAAAAKwAEAAYAAACYAAAAMzMzPzsABAAKAAAApQAAAAEAAAA7AAQACgAAAKYAAAABAAAAIAAEAKcAAAABAAAAYQAAADsABACnAAAAqAAAAAEAAAAZAAkAqQAAAAYAAAABAAAAAAAAAAAAAAAAAAAAAQAAAAAAAAAbAAMAqgAAAKkAAAAgAAQAqwAAAAAAAACqAAAAOwAEAKsAAACsAAAAAAAAADYABQACAAAABAAAAAAAAAADAAAA+AACAAUAAAA7AAQACAAAAAkAAAAHAAAAOwAEAAgAAAAOAAAABwAAADsABAAIAAAAEgAAAAcAAAA7AAQACAAAABYAAAAHAAAAOwAEABsAAAAcAAAABwAAADsABAAIAAAAHgAAAAcAAAA7AAQACAAAACEAAAAHAAAAOwAEAAgAAAA0AAAABwAAADsABAAbAAAAQQAAAAcAAAA7AAQAGwAAAEcAAAAHAAAAOwAEABsAAABIAAAABwAAADsABABNAAAATgAAAAcAAAA7AAQATQAAAFkAAAAHAAAAOwAEAGIAAABjAAAABwAAADsABAAIAAAAjAAAAAcAAAA9AAQABwAAAAwAAAALAAAADAAGAAcAAAANAAAAAQAAAEUAAAAMAAAAPgADAAkAAAANAAAAPQAEAAcAAAAQAAAADwAAAAwABgAHAAAAEQAAAAEAAABFAAAAEAAAAD4AAwAOAAAAEQAAAD0ABAAHAAAAFAAAABMAAAAMAAYABwAAABUAAAABAAAARQAAABQAAAA+AAMAEgAAABUAAAA9AAQABwAAABcAAAASAAAAPQAEAAcAAAAYAAAADgAAAIEABQAHAAAAGQAAABcAAAAYAAAADAAGAAcAAAAaAAAAAQAAAEUAAAAZAAAAPgADABYAAAAaAAAAPgADABwAAAAdAAAAPgADAB4AAAAgAAAAPQAEAAcAAAAjAAAAIgAAAD0ABAAHAAAAJAAAAB4AAACFAAUABwAAACUAAAAjAAAAJAAAAIUABQAHAAAAKgAAACUAAAApAAAAPQAEAAcAAAArAAAACQAAAD0ABAAHAAAALAAAABIAAACUAAUABgAAAC0AAAArAAAALAAAAAwABwAGAAAALwAAAAEAAAAoAAAALQAAAC4AAACOAAUABwAAADAAAAAqAAAALwAAAIUABQAHAAAAMwAAADAAAAAyAAAAPgADACEAAAAzAAAAPQAEAAcAAAA2AAAANQAAAD0ABAAHAAAANwAAAB4AAACFAAUABwAAADgAAAA2AAAANwAAAD0ABAAHAAAAOQAAAAkAAAA9AAQABwAAADoAAAAWAAAAlAAFAAYAAAA7AAAAOQAAADoAAAAMAAcABgAAADwAAAABAAAAKAAAADsAAAAuAAAAPQAEAAYAAAA9AAAAHAAAAAwABwAGAAAAPgAAAAEAAAAaAAAAPAAAAD0AAACOAAUABwAAAD8AAAA4AAAAPgAAAIUABQAHAAAAQAAAAD8AAAAyAAAAPgADADQAAABAAAAAPQAEAAYAAABFAAAARAAAAIUABQAGAAAARgAAAEIAAABFAAAAPgADAEEAAABGAAAAPgADAEcAAAAuAAAAPQAEAAYAAABKAAAASQAAAIgABQAGAAAASwAAADEAAABKAAAAPgADAEgAAABLAAAAPgADAE4AAABPAAAA+QACAFAAAAD4AAIAUAAAAPYABABSAAAAUwAAAAAAAAD5AAIAVAAAAPgAAgBUAAAAPQAEAEwAAABVAAAATgAAALMABQBXAAAAWAAAAFUAAABWAAAA+gAEAFgAAABRAAAAUgAAAPgAAgBRAAAAPgADAFkAAABPAAAA+QACAFoAAAD4AAIAWgAAAPYABABcAAAAXQAAAAAAAAD5AAIAXgAAAPgAAgBeAAAAPQAEAEwAAABfAAAAWQAAALMABQBXAAAAYAAAAF8AAABWAAAA+gAEAGAAAABbAAAAXAAAAPgAAgBbAAAAPQAEAEwAAABkAAAATgAAAG8ABAAGAAAAZQAAAGQAAAA9AAQATAAAAGYAAABZAAAAbwAEAAYAAABnAAAAZgAAAFAABQBhAAAAaAAAAGUAAABnAAAAPQAEAAYAAABpAAAASAAAAI4ABQBhAAAAagAAAGgAAABpAAAAPgADAGMAAABqAAAAPQAEAGwAAABvAAAAbgAAAD0ABABwAAAAcwAAAHIAAABPAAcAYQAAAHQAAABzAAAAcwAAAAAAAAABAAAAPQAEAGEAAAB1AAAAYwAAAIEABQBhAAAAdgAAAHQAAAB1AAAAQQAFAEMAAAB5AAAAcgAAAHgAAAA9AAQABgAAAHoAAAB5AAAAPQAEAAYAAAB7AAAAQQAAAIMABQAGAAAAfAAAAHoAAAB7AAAAUQAFAAYAAAB9AAAAdgAAAAAAAABRAAUABgAAAH4AAAB2AAAAAQAAAFAABgAHAAAAfwAAAH0AAAB+AAAAfAAAAFEABQAGAAAAgAAAAH8AAAACAAAAWQAGAAYAAACBAAAAbwAAAH8AAACAAAAAPQAEAAYAAACCAAAARwAAAIEABQAGAAAAgwAAAIIAAACBAAAAPgADAEcAAACDAAAA+QACAF0AAAD4AAIAXQAAAD0ABABMAAAAhAAAAFkAAACAAAUATAAAAIYAAACEAAAAhQAAAD4AAwBZAAAAhgAAAPkAAgBaAAAA+AACAFwAAAD5AAIAUwAAAPgAAgBTAAAAPQAEAEwAAACHAAAATgAAAIAABQBMAAAAiAAAAIcAAACFAAAAPgADAE4AAACIAAAA+QACAFAAAAD4AAIAUgAAAD0ABAAGAAAAigAAAEcAAACIAAUABgAAAIsAAACKAAAAiQAAAD4AAwBHAAAAiwAAAD0ABAAHAAAAjQAAACIAAACFAAUABwAAAJEAAACNAAAAkAAAAIUABQAHAAAAlAAAAJEAAACTAAAAPgADAIwAAACUAAAAPQAEAAcAAACXAAAAIQAAAI4ABQAHAAAAmQAAAJcAAACYAAAAPQAEAAcAAACaAAAANAAAAI4ABQAHAAAAmwAAAJoAAACYAAAAgQAFAAcAAACcAAAAmQAAAJsAAAA9AAQABgAAAJ0AAABHAAAAjgAFAAcAAACeAAAAnAAAAJ0AAAA9AAQABwAAAJ8AAACMAAAAgQAFAAcAAACgAAAAngAAAJ8AAABRAAUABgAAAKEAAACgAAAAAAAAAFEABQAGAAAAogAAAKAAAAABAAAAUQAFAAYAAACjAAAAoAAAAAIAAABQAAcAcAAAAKQAAAChAAAAogAAAKMAAAAxAAAAPgADAJYAAACkAAAA/QABADgAAQA=";
@@ -0,0 +1,82 @@
+// Objects are entities: a plain index with whichever components it was made
+// with. Transform (position, rotation, scale) and Kinematics (velocity,
+// acceleration, rotation speed) are the arrays in bodies, every entity has
+// those and its ID is its index there. The others live in a ComponentArray
+// each, packed without holes, so a system walks just the array it needs:
+// physics the colliders and scorables, the renderer the renderables.
+// Entities never gain or lose components after createObjects, so one array
+// per component keeps each archetype's entries together like archetype
+// tables would, without moving anything between them.
+
+typedef uint32_t Entity;
+
+// in ComponentArray::slots for entities without the component
+const uint32_t NO_COMPONENT = 0xFFFFFFFF;
+
+template <typename T>
+struct ComponentArray {
+  std::vector<T> components;
+  std::vector<Entity> entities; // whose each component is
+  std::vector<uint32_t> slots; // indexed by entity, into components
+};
+
+template <typename T>
+T& addComponent(struct ComponentArray<T>& array, Entity entity, const T& component)
+{
+  if (array.slots.size() <= entity)
+    array.slots.resize(entity + 1, NO_COMPONENT);
+  array.slots[entity] = static_cast<uint32_t>(array.components.size());
+  array.entities.push_back(entity);
+  array.components.push_back(component);
+  return array.components.back();
+}
+
+// NULL when the entity doesn't have one
+template <typename T>
+T* findComponent(struct ComponentArray<T>& array, Entity entity)
+{
+  if (entity >= array.slots.size() || array.slots[entity] == NO_COMPONENT)
+    return NULL;
+  return &array.components[array.slots[entity]];
+}
+
+Entity createEntity(const struct BodyDesc& desc)
+{
+  return addBody(desc);
+}
+
+// something the bird dies on, a pair of tubes with a gap between them
+struct Collider {
+  float gapHalfHeight = 3.57f; // at scale.z 1
+};
+
+// a pair of tubes that counts once the bird is past it
+struct Scorable {
+  bool isScored = false;
+};
+
+struct Renderable {
+  struct Model* model = NULL;
+
+  // picked from the projected size every frame
+  uint32_t lod = 0;
+  // index into textures and the bindless texture array
+  uint32_t texture = NO_TEXTURE;
+
+  std::vector<VkBuffer> shadowMapUniformBuffers;
+  std::vector<VkDeviceMemory> shadowMapUniformBuffersMemory;
+  std::vector<void*> shadowMapUniformBuffersMapped;
+
+  std::vector<VkBuffer> uniformBuffers;
+  std::vector<VkDeviceMemory> uniformBuffersMemory;
+  std::vector<void*> uniformBuffersMapped;
+
+  std::vector<VkDescriptorSet> shadowMapDescriptorSets;
+  std::vector<VkDescriptorSet> descriptorSets;
+};
+
+struct ComponentArray<struct Collider> colliders;
+struct ComponentArray<struct Scorable> scorables;
+struct ComponentArray<struct Renderable> renderables;
+
+Entity flappyBird = 0;
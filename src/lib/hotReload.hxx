@@ -0,0 +1,393 @@
+#ifndef IS_WINDOWS
+  #include <sys/inotify.h>
+#endif
+
+// Asset hot reload when running from the source tree (loose files, not
+// packed or embedded). A detached thread watches the directories of every
+// model and texture with inotify and queues the paths that were written.
+// Once per frame updateHotReload picks them up:
+//  - a changed .obj/.mtl is parsed again on the asset pool into a new Model,
+//    its buffers are uploaded with a fence that's never waited on, and once
+//    that signals they replace the old ones between two frames
+//  - a changed jpg/png is decoded on the asset pool and replaces the old
+//    image between two frames
+// Replaced buffers and images go into a deferred delete queue and are
+// destroyed when no frame in flight can use them anymore.
+
+// a model being parsed (fence not set yet) or uploaded again
+struct ModelReload {
+  struct Model model;
+  bool again = false; // its files changed again in the meantime
+  VkBuffer stagingBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  VkFence fence = VK_NULL_HANDLE;
+};
+
+// one of buffer or image (with its view), and the memory behind it
+struct RetiredResource {
+  uint64_t frame = 0; // hotReloadFrame when it was replaced
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkImage image = VK_NULL_HANDLE;
+  VkImageView view = VK_NULL_HANDLE;
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+};
+
+// paths relative to static/, filled by the watcher thread
+std::mutex changedAssetsMutex;
+std::vector<std::string> changedAssets;
+
+std::unordered_map<std::string, struct ModelReload> modelReloads; // by model name
+std::vector<uint32_t> textureReloads; // textures being decoded again
+std::queue<struct RetiredResource> retiredResources;
+uint64_t hotReloadFrame = 0;
+
+void retireBuffer(VkBuffer buffer, VkDeviceMemory memory)
+{
+  struct RetiredResource retired;
+  retired.frame = hotReloadFrame;
+  retired.buffer = buffer;
+  retired.memory = memory;
+  retiredResources.push(retired);
+}
+
+void retireImage(VkImage image, VkImageView view, VkDeviceMemory memory)
+{
+  struct RetiredResource retired;
+  retired.frame = hotReloadFrame;
+  retired.image = image;
+  retired.view = view;
+  retired.memory = memory;
+  retiredResources.push(retired);
+}
+
+// everything retired at least MAX_FRAMES_IN_FLIGHT frames ago, or all of it
+// after vkDeviceWaitIdle
+void destroyRetiredResources(bool all)
+{
+  while (!retiredResources.empty() && (all || retiredResources.front().frame + MAX_FRAMES_IN_FLIGHT <= hotReloadFrame))
+  {
+    const struct RetiredResource& retired = retiredResources.front();
+    vkDestroyBuffer(device, retired.buffer, NULL);
+    vkDestroyImageView(device, retired.view, NULL);
+    vkDestroyImage(device, retired.image, NULL);
+    vkFreeMemory(device, retired.memory, NULL);
+    retiredResources.pop();
+  }
+}
+
+// Watches the directories the models and textures were loaded from. Only
+// for loose files, edits to static/ don't change the asset pack or the
+// files embedded in the binary.
+void startAssetWatcher()
+{
+  if (HOT_RELOAD != 1)
+    return;
+  std::vector<std::string> paths;
+  for (const auto& model : Models)
+  {
+    paths.push_back(model.second.objPath);
+    paths.push_back(model.second.mtlPath);
+  }
+  for (const auto& texture : textures)
+    paths.push_back(texture.file.path);
+  paths.erase(std::remove_if(paths.begin(), paths.end(),
+      [](const std::string& path) { return path.empty() || !isLooseAsset(path); }), paths.end());
+  // with the defaults everything comes from the embedded blob
+  if (paths.empty())
+  {
+    printf("\033[33mWARN:\033[0m Hot reload is on but no asset is a loose file, it needs EMBEDDED_ASSETS 0 and no asset pack\n");
+    return;
+  }
+
+#ifdef IS_WINDOWS
+  printf("\033[33mWARN:\033[0m Hot reload needs inotify, it's off on Windows\n");
+#else
+  int fd = inotify_init1(IN_CLOEXEC);
+  if (fd < 0)
+  {
+    printf("\033[33mWARN:\033[0m Failed to start inotify, hot reload is off\n");
+    return;
+  }
+
+  // watch descriptor -> directory relative to static/, e.g. "obj/"
+  std::unordered_map<int, std::string> directories;
+  for (const auto& path : paths)
+  {
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    // saving in place closes the file, editors that save through a temporary file rename it over
+    int watch = inotify_add_watch(fd, ("static/" + directory).c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch >= 0)
+      directories[watch] = directory;
+  }
+  printf("Hot reload: watching %zu directories in static/\n", directories.size());
+
+  std::thread([fd, directories]() {
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+      ssize_t length = read(fd, buffer, sizeof(buffer));
+      if (length < 0 && errno == EINTR)
+        continue;
+      if (length <= 0)
+        return;
+      std::lock_guard<std::mutex> lock(changedAssetsMutex);
+      for (char* p = buffer; p < buffer + length;)
+      {
+        const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+        auto found = directories.find(event->wd);
+        if (found != directories.end() && event->len > 0)
+          changedAssets.push_back(found->second + event->name);
+        p += sizeof(struct inotify_event) + event->len;
+      }
+    }
+  }).detach();
+#endif
+}
+
+void startModelReload(const struct Model& current)
+{
+  auto found = modelReloads.find(current.name);
+  if (found != modelReloads.end())
+  {
+    found->second.again = true;
+    return;
+  }
+
+  // the map only changes on this thread and its values don't move
+  struct ModelReload& reload = modelReloads[current.name];
+  reload.model.name = current.name;
+  reload.model.objPath = current.objPath;
+  reload.model.mtlPath = current.mtlPath;
+  struct Model* target = &reload.model;
+  reload.model.loaded = assetPool.submit([target]() { loadModel(*target); });
+  printf("Hot reload: \"%s\" changed, parsing\n", current.objPath.c_str());
+}
+
+// vertices and indices go through one staging buffer, one submit with the
+// reload's fence
+void submitModelUpload(struct ModelReload& reload)
+{
+  struct Model& model = reload.model;
+  prepareModelVertexFormat(model);
+  VkDeviceSize vertexBytes = sizeof(struct GpuVertex) * model.vertexCount;
+  VkDeviceSize indexBytes = chooseIndexType(model);
+
+  createBuffer(vertexBytes + indexBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &reload.stagingBuffer, &reload.stagingBufferMemory);
+  char* data;
+  vkMapMemory(device, reload.stagingBufferMemory, 0, vertexBytes + indexBytes, 0, reinterpret_cast<void**>(&data));
+  packModelVertices(model, 0, model.vertexCount, reinterpret_cast<struct GpuVertex*>(data));
+  packModelIndices(model, 0, model.indexCount, data + vertexBytes);
+  vkUnmapMemory(device, reload.stagingBufferMemory);
+  releaseMeshData(model);
+
+  createBuffer(vertexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &model.vertexBuffer, &model.vertexBufferMemory);
+  createBuffer(indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &model.indexBuffer, &model.indexBufferMemory);
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+  vkAllocateCommandBuffers(device, &allocInfo, &reload.commandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(reload.commandBuffer, &beginInfo);
+  VkBufferCopy vertexCopy = { 0, 0, vertexBytes };
+  VkBufferCopy indexCopy = { vertexBytes, 0, indexBytes };
+  vkCmdCopyBuffer(reload.commandBuffer, reload.stagingBuffer, model.vertexBuffer, 1, &vertexCopy);
+  vkCmdCopyBuffer(reload.commandBuffer, reload.stagingBuffer, model.indexBuffer, 1, &indexCopy);
+  vkEndCommandBuffer(reload.commandBuffer);
+
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  vkCreateFence(device, &fenceInfo, NULL, &reload.fence);
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &reload.commandBuffer;
+  if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, reload.fence) != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to submit model upload\n");
+    exit(-1);
+  }
+}
+
+// the material count may have changed, so the whole table is rebuilt and
+// the buffer replaced when it got too small
+void reloadMaterials()
+{
+  buildMaterialTable();
+  if (sizeof(struct GpuMaterial) * materialTable.size() > materialBufferSize)
+  {
+    retireBuffer(materialBuffer, materialBufferMemory);
+    allocateMaterialBuffer();
+    writeMaterialDescriptor();
+  }
+  for (uint32_t i = 0; i < materialTable.size(); i++)
+    writeMaterial(i);
+}
+
+// the upload's fence has signaled, between two frames
+void finishModelReload(struct ModelReload& reload)
+{
+  vkDestroyFence(device, reload.fence, NULL);
+  vkFreeCommandBuffers(device, commandPool, 1, &reload.commandBuffer);
+  vkDestroyBuffer(device, reload.stagingBuffer, NULL);
+  vkFreeMemory(device, reload.stagingBufferMemory, NULL);
+
+  struct Model& current = Models[reload.model.name];
+  retireBuffer(current.vertexBuffer, current.vertexBufferMemory);
+  retireBuffer(current.indexBuffer, current.indexBufferMemory);
+  current = std::move(reload.model);
+
+  // textures can't be added while running, new maps wait for a restart
+  for (auto& material : current.materials)
+  {
+    if (material.diffuseMap.empty())
+      continue;
+    material.texture = findTexture(material.diffuseMap);
+    if (material.texture == NO_TEXTURE)
+      printf("\033[33mWARN:\033[0m \"%s\" is a new texture, it shows up after a restart\n", material.diffuseMap.c_str());
+  }
+  reloadMaterials();
+  printf("Hot reload: \"%s\" swapped in, %u vertices, %u indices\n", current.objPath.c_str(), current.vertexCount, current.indexCount);
+}
+
+void startTextureReload(uint32_t index)
+{
+  struct StreamedTexture& texture = textures[index];
+  if (texture.file.compiled)
+  {
+    printf("\033[33mWARN:\033[0m \"%s\" comes from compiled KTX2 files, rerun lib/compileTextures and restart\n", texture.file.path.c_str());
+    return;
+  }
+  if (std::find(textureReloads.begin(), textureReloads.end(), index) != textureReloads.end())
+    return; // the decode reads the file after this change anyway
+  submitTextureLoad(texture);
+  textureReloads.push_back(index);
+  printf("Hot reload: \"%s\" changed, decoding\n", texture.file.path.c_str());
+}
+
+// decoded on the asset pool, uploaded here between two frames
+void finishTextureReload(uint32_t index)
+{
+  struct StreamedTexture& texture = textures[index];
+  if (texture.file.pixels == NULL)
+  {
+    // half written or broken, the old image stays
+    printf("\033[33mWARN:\033[0m Failed to decode \"%s\", keeping the old texture\n", texture.file.path.c_str());
+    return;
+  }
+  retireImage(texture.image, texture.view, texture.imageMemory);
+  createDecodedTexture(texture);
+  writeTextureDescriptors(index);
+  printf("Hot reload: \"%s\" swapped in, %ux%u\n", texture.file.path.c_str(), texture.width, texture.height);
+}
+
+bool isReady(const std::shared_future<void>& future)
+{
+  return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Once per frame before recording, drawFrame has waited for the last
+// frame's fence so nothing recorded before is pending.
+void updateHotReload()
+{
+  if (HOT_RELOAD != 1)
+    return;
+  hotReloadFrame++;
+  destroyRetiredResources(false);
+
+  std::vector<std::string> changed;
+  {
+    std::lock_guard<std::mutex> lock(changedAssetsMutex);
+    changed.swap(changedAssets);
+  }
+  // a save usually shows up more than once
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  for (const auto& path : changed)
+  {
+    for (const auto& model : Models)
+      if (model.second.objPath == path || model.second.mtlPath == path)
+        startModelReload(model.second);
+    uint32_t texture = findTexture(path);
+    if (texture != NO_TEXTURE)
+      startTextureReload(texture);
+  }
+
+  std::vector<std::string> restarts;
+  for (auto it = modelReloads.begin(); it != modelReloads.end();)
+  {
+    struct ModelReload& reload = it->second;
+    if (reload.fence == VK_NULL_HANDLE)
+    {
+      if (isReady(reload.model.loaded))
+      {
+        if (reload.model.vertexCount == 0 || reload.model.indexCount == 0)
+        {
+          printf("\033[33mWARN:\033[0m \"%s\" has no triangles, keeping the old model\n", reload.model.objPath.c_str());
+          it = modelReloads.erase(it);
+          continue;
+        }
+        submitModelUpload(reload);
+      }
+      ++it;
+    }
+    else if (vkGetFenceStatus(device, reload.fence) == VK_SUCCESS)
+    {
+      if (reload.again)
+        restarts.push_back(it->first);
+      finishModelReload(reload);
+      it = modelReloads.erase(it);
+    }
+    else
+      ++it;
+  }
+  for (const auto& name : restarts)
+    startModelReload(Models[name]);
+
+  for (size_t i = 0; i < textureReloads.size();)
+  {
+    if (!isReady(textures[textureReloads[i]].loaded))
+    {
+      i++;
+      continue;
+    }
+    finishTextureReload(textureReloads[i]);
+    textureReloads.erase(textureReloads.begin() + i);
+  }
+}
+
+// after vkDeviceWaitIdle, before the models and textures go
+void destroyHotReload()
+{
+  for (auto& reload : modelReloads)
+  {
+    reload.second.model.loaded.wait();
+    releaseMeshData(reload.second.model);
+    if (reload.second.fence == VK_NULL_HANDLE)
+      continue;
+    vkDestroyFence(device, reload.second.fence, NULL);
+    vkFreeCommandBuffers(device, commandPool, 1, &reload.second.commandBuffer);
+    vkDestroyBuffer(device, reload.second.stagingBuffer, NULL);
+    vkFreeMemory(device, reload.second.stagingBufferMemory, NULL);
+    vkDestroyBuffer(device, reload.second.model.vertexBuffer, NULL);
+    vkFreeMemory(device, reload.second.model.vertexBufferMemory, NULL);
+    vkDestroyBuffer(device, reload.second.model.indexBuffer, NULL);
+    vkFreeMemory(device, reload.second.model.indexBufferMemory, NULL);
+  }
+  modelReloads.clear();
+  for (uint32_t index : textureReloads)
+  {
+    textures[index].loaded.wait();
+    stbi_image_free(textures[index].file.pixels);
+    textures[index].file.pixels = NULL;
+  }
+  textureReloads.clear();
+  destroyRetiredResources(true);
+}
@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include <stddef.h>
+
+// The parts of KTX 2.0 (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html)
+// that the texture compiler (lib/compileTextures) writes and the loader
+// reads: one 2D image, one layer, one face, no supercompression, every mip
+// level present. Shared by both, so no Vulkan headers here.
+
+const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// VkFormat values of the formats the compiler produces
+const uint32_t KTX2_FORMAT_RGBA8_SRGB = 43; // VK_FORMAT_R8G8B8A8_SRGB
+const uint32_t KTX2_FORMAT_BC7_SRGB = 146; // VK_FORMAT_BC7_SRGB_BLOCK
+const uint32_t KTX2_FORMAT_ETC2_RGB8_SRGB = 148; // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+
+struct Ktx2Header {
+  uint8_t identifier[12];
+  uint32_t vkFormat;
+  uint32_t typeSize;
+  uint32_t pixelWidth;
+  uint32_t pixelHeight;
+  uint32_t pixelDepth;
+  uint32_t layerCount;
+  uint32_t faceCount;
+  uint32_t levelCount;
+  uint32_t supercompressionScheme;
+  uint32_t dfdByteOffset;
+  uint32_t dfdByteLength;
+  uint32_t kvdByteOffset;
+  uint32_t kvdByteLength;
+  uint64_t sgdByteOffset;
+  uint64_t sgdByteLength;
+};
+
+// follows the header, levelCount of them, level 0 (the largest) first
+struct Ktx2Level {
+  uint64_t byteOffset;
+  uint64_t byteLength;
+  uint64_t uncompressedByteLength;
+};
+
+// bytes per 4x4 block, or per texel for RGBA8
+uint32_t ktx2BlockBytes(uint32_t vkFormat)
+{
+  switch (vkFormat)
+  {
+    case KTX2_FORMAT_RGBA8_SRGB: return 4;
+    case KTX2_FORMAT_BC7_SRGB: return 16;
+    case KTX2_FORMAT_ETC2_RGB8_SRGB: return 8;
+  }
+  return 0;
+}
+
+uint32_t ktx2BlockSize(uint32_t vkFormat)
+{
+  return vkFormat == KTX2_FORMAT_RGBA8_SRGB ? 1 : 4;
+}
+
+uint64_t ktx2LevelBytes(uint32_t vkFormat, uint32_t width, uint32_t height)
+{
+  uint32_t blockSize = ktx2BlockSize(vkFormat);
+  uint64_t blocksWide = (width + blockSize - 1) / blockSize;
+  uint64_t blocksHigh = (height + blockSize - 1) / blockSize;
+  return blocksWide * blocksHigh * ktx2BlockBytes(vkFormat);
+}
@@ -0,0 +1,137 @@
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md),
+// shared by lib/embedFiles, which compresses once at build time, and the
+// runtime, which decompresses at startup. Each sequence is a token (literal
+// length << 4 | match length - 4), the literals, a 16 bit offset back into
+// the output and the rest of the match length. The compressor is the greedy
+// single hash table kind, decompression is a few memcpys per sequence.
+
+const size_t LZ4_MIN_MATCH = 4;
+const size_t LZ4_LAST_LITERALS = 5; // a block always ends in at least this many literals
+const size_t LZ4_MATCH_LIMIT = 12; // no match starts closer than this to the end
+const size_t LZ4_MAX_OFFSET = 65535;
+const int LZ4_HASH_BITS = 16;
+
+// lengths of 15 and up continue in bytes of 255 until a smaller one
+void lz4WriteLength(std::string& out, size_t length)
+{
+  for (; length >= 255; length -= 255)
+    out.push_back(static_cast<char>(255));
+  out.push_back(static_cast<char>(length));
+}
+
+void lz4WriteSequence(std::string& out, const char* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+  size_t matchCode = matchLength > 0 ? matchLength - LZ4_MIN_MATCH : 0;
+  out.push_back(static_cast<char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+  if (literalCount >= 15)
+    lz4WriteLength(out, literalCount - 15);
+  out.append(literals, literalCount);
+  if (matchLength == 0)
+    return; // the last sequence is literals only
+  out.push_back(static_cast<char>(offset & 0xFF));
+  out.push_back(static_cast<char>(offset >> 8));
+  if (matchCode >= 15)
+    lz4WriteLength(out, matchCode - 15);
+}
+
+std::string lz4Compress(const char* src, size_t size)
+{
+  auto read32 = [src](size_t position) { uint32_t value; memcpy(&value, src + position, 4); return value; };
+  auto hash = [](uint32_t value) { return (value * 2654435761u) >> (32 - LZ4_HASH_BITS); };
+
+  std::string out;
+  out.reserve(size + size / 255 + 16);
+  // last position each 4 byte sequence was seen at
+  std::vector<uint32_t> table(size_t(1) << LZ4_HASH_BITS, UINT32_MAX);
+  size_t anchor = 0; // first byte not written yet
+  size_t position = 0;
+  size_t matchStartLimit = size > LZ4_MATCH_LIMIT ? size - LZ4_MATCH_LIMIT : 0;
+  while (position < matchStartLimit)
+  {
+    uint32_t sequence = read32(position);
+    uint32_t& slot = table[hash(sequence)];
+    size_t candidate = slot;
+    slot = static_cast<uint32_t>(position);
+    if (candidate == UINT32_MAX || position - candidate > LZ4_MAX_OFFSET || read32(candidate) != sequence)
+    {
+      position++;
+      continue;
+    }
+
+    size_t length = LZ4_MIN_MATCH;
+    while (position + length < size - LZ4_LAST_LITERALS && src[candidate + length] == src[position + length])
+      length++;
+    // the bytes right before often match too, they'd be literals otherwise
+    while (position > anchor && candidate > 0 && src[position - 1] == src[candidate - 1])
+    {
+      position--;
+      candidate--;
+      length++;
+    }
+    lz4WriteSequence(out, src + anchor, position - anchor, position - candidate, length);
+    position += length;
+    anchor = position;
+  }
+  lz4WriteSequence(out, src + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+// false when src isn't a block that decompresses to exactly dstSize bytes
+bool lz4Decompress(const char* src, size_t srcSize, char* dst, size_t dstSize)
+{
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  const uint8_t* inEnd = in + srcSize;
+  size_t written = 0;
+  auto readLength = [&in, inEnd](size_t& length) {
+    uint8_t byte;
+    do
+    {
+      if (in >= inEnd)
+        return false;
+      byte = *in++;
+      length += byte;
+    } while (byte == 255);
+    return true;
+  };
+
+  while (in < inEnd)
+  {
+    uint8_t token = *in++;
+    size_t literalCount = token >> 4;
+    if (literalCount == 15 && !readLength(literalCount))
+      return false;
+    if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > dstSize - written)
+      return false;
+    memcpy(dst + written, in, literalCount);
+    in += literalCount;
+    written += literalCount;
+    if (in == inEnd)
+      break;
+
+    if (inEnd - in < 2)
+      return false;
+    size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t length = token & 15;
+    if (length == 15 && !readLength(length))
+      return false;
+    length += LZ4_MIN_MATCH;
+    if (offset == 0 || offset > written || length > dstSize - written)
+      return false;
+    char* to = dst + written;
+    const char* from = to - offset;
+    if (offset >= length)
+      memcpy(to, from, length);
+    else // overlapping, the last offset bytes repeat
+      for (size_t i = 0; i < length; i++)
+        to[i] = from[i];
+    written += length;
+  }
+  return written == dstSize;
+}
@@ -0,0 +1,111 @@
+#ifndef IS_WINDOWS
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file. Parsers work on the bytes
+// directly instead of going through ifstream/getline copies.
+struct MappedFile {
+  const char* data = NULL;
+  size_t size = 0;
+  // points into a mapping owned by someone else (the asset pack), unmapping only forgets it
+  bool borrowed = false;
+#ifdef IS_WINDOWS
+  HANDLE fileHandle = INVALID_HANDLE_VALUE;
+  HANDLE mappingHandle = NULL;
+#endif
+};
+
+bool mapFile(const std::string& path, struct MappedFile& file)
+{
+  file.data = NULL;
+  file.size = 0;
+  file.borrowed = false;
+#ifdef IS_WINDOWS
+  file.fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file.fileHandle == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(file.fileHandle, &fileSize);
+  file.size = static_cast<size_t>(fileSize.QuadPart);
+  // empty files can't be mapped, an empty view is still a valid file
+  if (file.size == 0)
+    return true;
+
+  file.mappingHandle = CreateFileMappingA(file.fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (file.mappingHandle == NULL)
+  {
+    CloseHandle(file.fileHandle);
+    file.fileHandle = INVALID_HANDLE_VALUE;
+    return false;
+  }
+  file.data = static_cast<const char*>(MapViewOfFile(file.mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (file.data == NULL)
+  {
+    CloseHandle(file.mappingHandle);
+    CloseHandle(file.fileHandle);
+    file.mappingHandle = NULL;
+    file.fileHandle = INVALID_HANDLE_VALUE;
+    return false;
+  }
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return false;
+  }
+  file.size = static_cast<size_t>(fileStat.st_size);
+  if (file.size == 0)
+  {
+    close(fd);
+    return true;
+  }
+
+  void* mapping = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference to the file
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    file.size = 0;
+    return false;
+  }
+  // parsed front to back once
+  madvise(mapping, file.size, MADV_SEQUENTIAL);
+  file.data = static_cast<const char*>(mapping);
+#endif
+  return true;
+}
+
+void unmapFile(struct MappedFile& file)
+{
+  if (file.borrowed)
+  {
+    file.data = NULL;
+    file.size = 0;
+    file.borrowed = false;
+    return;
+  }
+#ifdef IS_WINDOWS
+  if (file.data != NULL)
+    UnmapViewOfFile(file.data);
+  if (file.mappingHandle != NULL)
+    CloseHandle(file.mappingHandle);
+  if (file.fileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle(file.fileHandle);
+  file.mappingHandle = NULL;
+  file.fileHandle = INVALID_HANDLE_VALUE;
+#else
+  if (file.data != NULL)
+    munmap(const_cast<char*>(file.data), file.size);
+#endif
+  file.data = NULL;
+  file.size = 0;
+}
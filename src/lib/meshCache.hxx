@@ -0,0 +1,195 @@
+#include <filesystem>
+
+// Binary mesh cache. After the first parse the deduplicated vertex and index
+// arrays are written to cache/ and keyed by a hash of the .obj and .mtl
+// contents. Later launches map the file and copy the arrays straight into
+// the staging buffers without touching the text.
+//
+// Layout: MeshCacheHeader, vertices at vertexOffset, indices of all LODs at
+// indexOffset, lodCount MeshLod ranges at lodOffset.
+// Everything is little endian and only read back on the machine that wrote it.
+
+const uint32_t MESH_CACHE_MAGIC = 0x4D424656; // "VFBM"
+const uint32_t MESH_CACHE_VERSION = 6; // bump when the layout or the loader output changes
+const char* MESH_CACHE_DIRECTORY = "cache/";
+
+struct MeshCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t sourceHash;
+  uint32_t vertexStride;
+  uint32_t vertexCount;
+  uint32_t indexCount;
+  uint32_t lodCount;
+  float boundsMin[3];
+  float boundsMax[3];
+  uint64_t vertexOffset;
+  uint64_t indexOffset;
+  uint64_t lodOffset;
+};
+
+bool hashMeshSources(const struct Model& model, uint64_t& hash)
+{
+  // loader settings that change the output are part of the key
+  const uint32_t loaderConfig[3] = { MESH_CACHE_VERSION, OPTIMIZE_MESHES, MESH_LODS };
+  hash = hashBytes(reinterpret_cast<const char*>(loaderConfig), sizeof(loaderConfig));
+  for (const std::string* path : { &model.objPath, &model.mtlPath })
+  {
+    if (path->compare("") == 0)
+      continue;
+
+    uint64_t fileHash = 0;
+    uint64_t fileSize = 0;
+    if (!hashAsset(*path, fileHash, fileSize))
+      return false;
+    hash = hashBytes(reinterpret_cast<const char*>(&fileHash), sizeof(fileHash), hash);
+    // separates the obj from the mtl so bytes can't move between them unnoticed
+    hash = hashBytes(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize), hash);
+  }
+  return true;
+}
+
+std::string meshCachePath(const struct Model& model)
+{
+  std::string fileName = model.objPath;
+  for (char& c : fileName) if (c == '/' || c == '\\') c = '_';
+  return MESH_CACHE_DIRECTORY + fileName + ".mesh";
+}
+
+void computeModelBounds(struct Model& model)
+{
+  model.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+  model.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+  for (const auto& vertex : model.vertices)
+  {
+    model.boundsMin = glm::min(model.boundsMin, vertex.pos);
+    model.boundsMax = glm::max(model.boundsMax, vertex.pos);
+  }
+  if (model.vertices.empty())
+  {
+    model.boundsMin = glm::vec3(0.0f);
+    model.boundsMax = glm::vec3(0.0f);
+  }
+}
+
+// points the upload at the parsed arrays
+void useParsedMesh(struct Model& model)
+{
+  model.vertexData = model.vertices.data();
+  model.indexData = model.indices.data();
+  model.vertexCount = static_cast<uint32_t>(model.vertices.size());
+  model.indexCount = static_cast<uint32_t>(model.indices.size());
+}
+
+bool loadMeshCache(struct Model& model, uint64_t sourceHash)
+{
+  std::string path = meshCachePath(model);
+  struct MappedFile file;
+  if (!mapFile(path, file))
+    return false;
+
+  MeshCacheHeader header;
+  bool valid = file.size >= sizeof(header);
+  if (valid)
+  {
+    memcpy(&header, file.data, sizeof(header));
+    valid = header.magic == MESH_CACHE_MAGIC &&
+      header.version == MESH_CACHE_VERSION &&
+      header.sourceHash == sourceHash &&
+      header.vertexStride == sizeof(struct Vertex) &&
+      header.vertexOffset % alignof(struct Vertex) == 0 &&
+      header.indexOffset % alignof(uint32_t) == 0 &&
+      header.vertexOffset + static_cast<uint64_t>(header.vertexCount) * sizeof(struct Vertex) <= file.size &&
+      header.indexOffset + static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t) <= file.size &&
+      header.lodCount > 0 &&
+      header.lodOffset + static_cast<uint64_t>(header.lodCount) * sizeof(struct MeshLod) <= file.size;
+  }
+  if (valid)
+  {
+    model.lods.resize(header.lodCount);
+    memcpy(model.lods.data(), file.data + header.lodOffset, header.lodCount * sizeof(struct MeshLod));
+    for (const auto& lod : model.lods)
+      valid = valid && static_cast<uint64_t>(lod.firstIndex) + lod.indexCount <= header.indexCount;
+  }
+  if (!valid)
+  {
+    // stale or from another build, gets rewritten after the parse
+    unmapFile(file);
+    model.lods.clear();
+    return false;
+  }
+
+  model.meshCacheFile = file;
+  model.vertexData = reinterpret_cast<const struct Vertex*>(file.data + header.vertexOffset);
+  model.indexData = reinterpret_cast<const uint32_t*>(file.data + header.indexOffset);
+  model.vertexCount = header.vertexCount;
+  model.indexCount = header.indexCount;
+  model.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+  model.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+  return true;
+}
+
+void writeMeshCache(const struct Model& model, uint64_t sourceHash)
+{
+  std::error_code error;
+  std::filesystem::create_directories(MESH_CACHE_DIRECTORY, error);
+
+  MeshCacheHeader header = {};
+  header.magic = MESH_CACHE_MAGIC;
+  header.version = MESH_CACHE_VERSION;
+  header.sourceHash = sourceHash;
+  header.vertexStride = sizeof(struct Vertex);
+  header.vertexCount = model.vertexCount;
+  header.indexCount = model.indexCount;
+  header.lodCount = static_cast<uint32_t>(model.lods.size());
+  header.boundsMin[0] = model.boundsMin.x;
+  header.boundsMin[1] = model.boundsMin.y;
+  header.boundsMin[2] = model.boundsMin.z;
+  header.boundsMax[0] = model.boundsMax.x;
+  header.boundsMax[1] = model.boundsMax.y;
+  header.boundsMax[2] = model.boundsMax.z;
+  // 16 byte aligned sections so the mapped arrays can be used in place
+  header.vertexOffset = (sizeof(header) + 15) & ~static_cast<uint64_t>(15);
+  header.indexOffset = (header.vertexOffset + static_cast<uint64_t>(model.vertexCount) * sizeof(struct Vertex) + 15) & ~static_cast<uint64_t>(15);
+  header.lodOffset = header.indexOffset + static_cast<uint64_t>(model.indexCount) * sizeof(uint32_t);
+
+  // written next to the real file and renamed, a crash never leaves half a cache behind
+  std::string path = meshCachePath(model);
+  std::string tempPath = path + ".tmp";
+  FILE* file = fopen(tempPath.c_str(), "wb");
+  if (file == NULL)
+  {
+    std::cout << "Can't write mesh cache " << path << ", skipping\n";
+    return;
+  }
+
+  const char padding[16] = {};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = ok && fwrite(padding, 1, header.vertexOffset - sizeof(header), file) == header.vertexOffset - sizeof(header);
+  ok = ok && fwrite(model.vertexData, sizeof(struct Vertex), model.vertexCount, file) == model.vertexCount;
+  uint64_t vertexEnd = header.vertexOffset + static_cast<uint64_t>(model.vertexCount) * sizeof(struct Vertex);
+  ok = ok && fwrite(padding, 1, header.indexOffset - vertexEnd, file) == header.indexOffset - vertexEnd;
+  ok = ok && fwrite(model.indexData, sizeof(uint32_t), model.indexCount, file) == model.indexCount;
+  ok = ok && fwrite(model.lods.data(), sizeof(struct MeshLod), model.lods.size(), file) == model.lods.size();
+  ok = (fclose(file) == 0) && ok;
+
+  if (ok)
+    std::filesystem::rename(tempPath, path, error);
+  if (!ok || error)
+  {
+    std::cout << "Can't write mesh cache " << path << ", skipping\n";
+    std::filesystem::remove(tempPath, error);
+  }
+}
+
+// The parsed or mapped arrays are only needed until they are staged for
+// the GPU buffers. Counts, bounds and LODs stay.
+void releaseMeshData(struct Model& model)
+{
+  if (model.meshCacheFile.data != NULL)
+    unmapFile(model.meshCacheFile);
+  std::vector<struct Vertex>().swap(model.vertices);
+  std::vector<uint32_t>().swap(model.indices);
+  model.vertexData = NULL;
+  model.indexData = NULL;
+}
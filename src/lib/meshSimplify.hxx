@@ -0,0 +1,364 @@
+// Mesh LOD chain with quadric error metrics (Garland & Heckbert 1997).
+//
+// Simplification works on welded positions, so the flat shaded meshes with a
+// separate vertex per face corner still collapse as one surface. Collapses
+// only move a position onto a neighbouring one, so every LOD keeps indexing
+// the original vertex buffer and only needs its own index range. Edges on
+// open borders and between different materials get extra constraint planes
+// so outlines and color boundaries stay put.
+
+#include <queue>
+
+struct Quadric {
+  // symmetric 4x4: a2 ab ac ad b2 bc bd c2 cd d2
+  double q[10] = {};
+  // triangle area behind the face planes, turns the error into a distance
+  double area = 0.0;
+
+  void addPlane(const glm::dvec3& n, double d, double weight)
+  {
+    q[0] += weight * n.x * n.x; q[1] += weight * n.x * n.y; q[2] += weight * n.x * n.z; q[3] += weight * n.x * d;
+    q[4] += weight * n.y * n.y; q[5] += weight * n.y * n.z; q[6] += weight * n.y * d;
+    q[7] += weight * n.z * n.z; q[8] += weight * n.z * d;
+    q[9] += weight * d * d;
+  }
+
+  void add(const Quadric& other)
+  {
+    for (int i = 0; i < 10; i++) q[i] += other.q[i];
+    area += other.area;
+  }
+
+  double evaluate(const glm::dvec3& p) const
+  {
+    return p.x * p.x * q[0] + 2.0 * p.x * p.y * q[1] + 2.0 * p.x * p.z * q[2] + 2.0 * p.x * q[3]
+      + p.y * p.y * q[4] + 2.0 * p.y * p.z * q[5] + 2.0 * p.y * q[6]
+      + p.z * p.z * q[7] + 2.0 * p.z * q[8]
+      + q[9];
+  }
+};
+
+struct MeshSimplifier {
+  const std::vector<struct Vertex>& vertices;
+  const std::vector<uint32_t>& indices;
+
+  // welded positions
+  std::vector<uint32_t> positionOf; // vertex -> position
+  std::vector<glm::dvec3> positions;
+  std::vector<std::vector<uint32_t>> verticesAt; // position -> vertices
+  std::vector<uint32_t> collapsedTo; // position -> position it was merged into (itself if alive)
+  std::vector<uint32_t> versions;
+  std::vector<Quadric> quadrics;
+  std::vector<std::vector<uint32_t>> trianglesAt; // position -> triangles, may hold dead ones
+
+  std::vector<bool> triangleAlive;
+  size_t liveTriangleCount = 0;
+  // largest error of all collapses so far, in model units
+  double error = 0.0;
+
+  struct Collapse {
+    double cost;
+    uint32_t from, to;
+    uint32_t fromVersion, toVersion;
+    bool operator<(const Collapse& other) const { return cost > other.cost; } // min heap
+  };
+  std::priority_queue<Collapse> collapses;
+
+  MeshSimplifier(const std::vector<struct Vertex>& vertices, const std::vector<uint32_t>& indices)
+    : vertices(vertices), indices(indices)
+  {
+    weldPositions();
+    buildQuadrics();
+    for (uint32_t position = 0; position < positions.size(); position++)
+      pushCollapses(position);
+  }
+
+  uint32_t corner(uint32_t triangle, int c) { return find(positionOf[indices[triangle * 3 + c]]); }
+
+  uint32_t find(uint32_t position)
+  {
+    while (collapsedTo[position] != position)
+    {
+      collapsedTo[position] = collapsedTo[collapsedTo[position]];
+      position = collapsedTo[position];
+    }
+    return position;
+  }
+
+  void weldPositions()
+  {
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+    positionOf.resize(vertices.size());
+    for (uint32_t v = 0; v < vertices.size(); v++)
+    {
+      const glm::vec3& p = vertices[v].pos;
+      Vertex key = {};
+      key.pos = p;
+      uint64_t h = hashVertex(key);
+      uint32_t found = UINT32_MAX;
+      for (uint32_t candidate : buckets[h])
+        if (glm::vec3(positions[candidate]) == p) { found = candidate; break; }
+      if (found == UINT32_MAX)
+      {
+        found = static_cast<uint32_t>(positions.size());
+        positions.push_back(glm::dvec3(p));
+        verticesAt.emplace_back();
+        buckets[h].push_back(found);
+      }
+      positionOf[v] = found;
+      verticesAt[found].push_back(v);
+    }
+    collapsedTo.resize(positions.size());
+    for (uint32_t i = 0; i < collapsedTo.size(); i++) collapsedTo[i] = i;
+    versions.assign(positions.size(), 0);
+    quadrics.assign(positions.size(), Quadric());
+    trianglesAt.assign(positions.size(), {});
+  }
+
+  void buildQuadrics()
+  {
+    size_t triangleCount = indices.size() / 3;
+    triangleAlive.assign(triangleCount, true);
+    liveTriangleCount = triangleCount;
+
+    // edge -> adjacent triangles, for borders and material boundaries
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> edges;
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+      return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+      uint32_t p[3] = { positionOf[indices[t * 3]], positionOf[indices[t * 3 + 1]], positionOf[indices[t * 3 + 2]] };
+      if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2])
+      {
+        triangleAlive[t] = false;
+        liveTriangleCount--;
+        continue;
+      }
+      glm::dvec3 normal = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+      double length = glm::length(normal);
+      if (length > 0.0)
+      {
+        normal /= length;
+        // area weighted, big triangles hold their plane harder
+        for (int c = 0; c < 3; c++)
+        {
+          quadrics[p[c]].addPlane(normal, -glm::dot(normal, positions[p[0]]), length * 0.5);
+          quadrics[p[c]].area += length * 0.5;
+        }
+      }
+      for (int c = 0; c < 3; c++)
+      {
+        trianglesAt[p[c]].push_back(t);
+        auto inserted = edges.try_emplace(edgeKey(p[c], p[(c + 1) % 3]), t, UINT32_MAX);
+        if (!inserted.second)
+          inserted.first->second.second = t;
+      }
+    }
+
+    for (const auto& edge : edges)
+    {
+      uint32_t t0 = edge.second.first;
+      uint32_t t1 = edge.second.second;
+      bool border = t1 == UINT32_MAX ||
+        vertices[indices[t0 * 3]].material != vertices[indices[t1 * 3]].material;
+      if (!border)
+        continue;
+
+      uint32_t a = static_cast<uint32_t>(edge.first >> 32);
+      uint32_t b = static_cast<uint32_t>(edge.first & 0xFFFFFFFF);
+      uint32_t p[3] = { positionOf[indices[t0 * 3]], positionOf[indices[t0 * 3 + 1]], positionOf[indices[t0 * 3 + 2]] };
+      glm::dvec3 faceNormal = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+      glm::dvec3 edgeVector = positions[b] - positions[a];
+      glm::dvec3 normal = glm::cross(edgeVector, faceNormal);
+      double length = glm::length(normal);
+      if (length <= 0.0)
+        continue;
+      normal /= length;
+      // plane through the edge, perpendicular to the face
+      double weight = 1000.0 * glm::dot(edgeVector, edgeVector);
+      quadrics[a].addPlane(normal, -glm::dot(normal, positions[a]), weight);
+      quadrics[b].addPlane(normal, -glm::dot(normal, positions[a]), weight);
+    }
+  }
+
+  void pushCollapses(uint32_t position)
+  {
+    for (uint32_t t : trianglesAt[position])
+    {
+      if (!triangleAlive[t])
+        continue;
+      for (int c = 0; c < 3; c++)
+      {
+        uint32_t other = corner(t, c);
+        if (other == position)
+          continue;
+        pushCollapse(position, other);
+        pushCollapse(other, position);
+      }
+    }
+  }
+
+  void pushCollapse(uint32_t from, uint32_t to)
+  {
+    Quadric combined = quadrics[from];
+    combined.add(quadrics[to]);
+    // root mean square distance to the merged planes, borders count a lot more
+    double cost = std::sqrt(std::max(combined.evaluate(positions[to]), 0.0) / std::max(combined.area, 1e-12));
+    collapses.push({ cost, from, to, versions[from], versions[to] });
+  }
+
+  // moving from onto to mustn't flip any of the triangles that stay
+  bool collapseFlips(uint32_t from, uint32_t to)
+  {
+    for (uint32_t t : trianglesAt[from])
+    {
+      if (!triangleAlive[t])
+        continue;
+      uint32_t p[3] = { corner(t, 0), corner(t, 1), corner(t, 2) };
+      if (p[0] == to || p[1] == to || p[2] == to)
+        continue; // collapses to nothing
+      glm::dvec3 before = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+      for (int c = 0; c < 3; c++)
+        if (p[c] == from) p[c] = to;
+      glm::dvec3 after = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+      if (glm::dot(before, after) <= 0.2 * glm::length(before) * glm::length(after))
+        return true;
+    }
+    return false;
+  }
+
+  // collapses edges until targetTriangles are left or the next one would move the surface more than maxError
+  void simplify(size_t targetTriangles, double maxError)
+  {
+    while (liveTriangleCount > targetTriangles && !collapses.empty())
+    {
+      Collapse collapse = collapses.top();
+      if (collapse.cost > maxError)
+        break;
+      collapses.pop();
+
+      if (find(collapse.from) != collapse.from || find(collapse.to) != collapse.to)
+        continue;
+      if (collapse.fromVersion != versions[collapse.from] || collapse.toVersion != versions[collapse.to])
+        continue; // a newer entry for this pair is in the queue
+      if (collapseFlips(collapse.from, collapse.to))
+        continue;
+
+      collapsedTo[collapse.from] = collapse.to;
+      error = std::max(error, collapse.cost);
+      quadrics[collapse.to].add(quadrics[collapse.from]);
+      versions[collapse.to]++;
+      versions[collapse.from]++;
+      for (uint32_t t : trianglesAt[collapse.from])
+      {
+        if (!triangleAlive[t])
+          continue;
+        uint32_t p[3] = { corner(t, 0), corner(t, 1), corner(t, 2) };
+        if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2])
+        {
+          triangleAlive[t] = false;
+          liveTriangleCount--;
+        }
+        else
+        {
+          trianglesAt[collapse.to].push_back(t);
+        }
+      }
+      trianglesAt[collapse.from].clear();
+      pushCollapses(collapse.to);
+    }
+  }
+
+  // the vertex at a collapsed position that looks most like the original
+  uint32_t replacementVertex(uint32_t vertex, uint32_t position)
+  {
+    const struct Vertex& original = vertices[vertex];
+    uint32_t best = verticesAt[position][0];
+    float bestScore = std::numeric_limits<float>::max();
+    for (uint32_t candidate : verticesAt[position])
+    {
+      const struct Vertex& v = vertices[candidate];
+      float score = (v.material != original.material ? 10.0f : 0.0f)
+        + (1.0f - glm::dot(v.normal, original.normal))
+        + glm::length(v.texCoord - original.texCoord);
+      if (score < bestScore)
+      {
+        bestScore = score;
+        best = candidate;
+      }
+    }
+    return best;
+  }
+
+  void appendIndices(std::vector<uint32_t>& out)
+  {
+    for (uint32_t t = 0; t < triangleAlive.size(); t++)
+    {
+      if (!triangleAlive[t])
+        continue;
+      for (int c = 0; c < 3; c++)
+      {
+        uint32_t vertex = indices[t * 3 + c];
+        uint32_t position = find(positionOf[vertex]);
+        out.push_back(position == positionOf[vertex] ? vertex : replacementVertex(vertex, position));
+      }
+    }
+  }
+};
+
+// Appends MESH_LODS - 1 simplified index lists after LOD0 in indices, each
+// with about half the triangles of the one before, and fills lods. Stops
+// early when a mesh can't be simplified further without visible damage.
+void buildMeshLods(const std::string& name, const std::vector<struct Vertex>& vertices,
+    std::vector<uint32_t>& indices, std::vector<struct MeshLod>& lods)
+{
+  lods.clear();
+  lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+  size_t triangleCount = indices.size() / 3;
+  if (MESH_LODS <= 1 || triangleCount < 64)
+    return;
+
+  glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+  for (const auto& vertex : vertices)
+  {
+    boundsMin = glm::min(boundsMin, vertex.pos);
+    boundsMax = glm::max(boundsMax, vertex.pos);
+  }
+  // a few percent of the mesh size, past that the silhouette falls apart
+  double maxError = glm::length(glm::dvec3(boundsMax - boundsMin)) * 0.05;
+
+  std::vector<uint32_t> lod0(indices);
+  MeshSimplifier simplifier(vertices, lod0);
+  printf("  %s LODs: %zu", name.c_str(), triangleCount);
+  size_t previousTriangles = triangleCount;
+  for (int level = 1; level < MESH_LODS; level++)
+  {
+    simplifier.simplify(previousTriangles / 2, maxError);
+    // not worth another level
+    if (simplifier.liveTriangleCount * 10 > previousTriangles * 9)
+      break;
+
+    std::vector<uint32_t> lodIndices;
+    simplifier.appendIndices(lodIndices);
+    std::vector<size_t> clusterStarts;
+    std::vector<uint32_t> triangles = tipsifyTriangles(lodIndices, vertices.size(), clusterStarts);
+
+    struct MeshLod lod;
+    lod.firstIndex = static_cast<uint32_t>(indices.size());
+    lod.indexCount = static_cast<uint32_t>(triangles.size() * 3);
+    lod.error = static_cast<float>(simplifier.error);
+    for (uint32_t t : triangles)
+    {
+      indices.push_back(lodIndices[t * 3 + 0]);
+      indices.push_back(lodIndices[t * 3 + 1]);
+      indices.push_back(lodIndices[t * 3 + 2]);
+    }
+    lods.push_back(lod);
+    previousTriangles = simplifier.liveTriangleCount;
+    printf(" -> %zu (%.3g)", previousTriangles, simplifier.error);
+  }
+  printf(" triangles\n");
+}
@@ -0,0 +1,33 @@
+#include <stdint.h>
+#include <string>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+// Plain mesh data, no Vulkan in here: the game, lib/checkVertexDedup and
+// the OBJ loader all use it.
+
+// Renderable::texture and Material::texture when there is none
+const uint32_t NO_TEXTURE = 0xFFFFFFFF;
+
+// One newmtl of a model's .mtl, see loadMTL. Defaults are what the shader
+// used before materials were read.
+struct Material {
+  std::string name = "";
+  glm::vec3 diffuse = glm::vec3(1.0f); // Kd
+  glm::vec3 specular = glm::vec3(0.3f); // Ks
+  float shininess = 16.0f; // Ns
+  std::string diffuseMap = ""; // map_Kd, relative to static/
+  // index into textures, set once the map is registered
+  uint32_t texture = NO_TEXTURE;
+};
+
+struct Vertex {
+  glm::vec3 pos;
+  uint32_t material; // index into Model::materials
+	glm::vec3 normal;
+  glm::vec2 texCoord;
+
+  bool operator==(const Vertex& other) const {
+      return pos == other.pos && material == other.material && normal == other.normal && texCoord == other.texCoord;
+  }
+};
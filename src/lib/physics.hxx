@@ -6,13 +6,71 @@ uint32_t bestScore = 0;
 
 short countDown = 0;
 
-const float JUMP_SPEED = 0.05f;
+const float JUMP_SPEED = 24.0f;
+const float PHYSICS_STEP = 1.0f / static_cast<float>(PHYSICS_FPS);
 bool isGoing = true;
+// set by the input callbacks, the physics thread does the jump on its next tick
+std::atomic<bool> jumpRequested{false};
+
+// The bird flies through the tubes between these x, and scores a pair once
+// it is left of TUBE_SCORE_X.
+const float TUBE_HIT_MIN_X = -2.32f;
+const float TUBE_HIT_MAX_X = 2.9f;
+const float TUBE_SCORE_X = -2.15f;
+// tubes this far left go back to TUBE_RESPAWN_X
+const float TUBE_WRAP_X = -40.0f;
+const float TUBE_RESPAWN_X = 160.0f;
+
+// Tubes sorted by x, as a ring starting at tubeRingHead. They all move left
+// at the same speed and only the first one ever wraps around to the back,
+// so wrapping moves the head on and the order holds without sorting again.
+// The bird finds the tubes next to it with a binary search instead of
+// looking at all of them.
+std::vector<Entity> tubeRing;
+uint32_t tubeRingHead = 0;
+
+Entity tubeAt(uint32_t position)
+{
+  return tubeRing[(tubeRingHead + position) % tubeRing.size()];
+}
+
+float tubeX(uint32_t position)
+{
+  return bodies.positionX[tubeAt(position)];
+}
+
+// after the tubes were placed anew
+void sortTubeRing()
+{
+  tubeRing = colliders.entities;
+  std::sort(tubeRing.begin(), tubeRing.end(), [](Entity a, Entity b) {
+    return bodies.positionX[a] < bodies.positionX[b];
+  });
+  tubeRingHead = 0;
+}
+
+// ring position of the first tube right of x
+uint32_t findTube(float x)
+{
+  uint32_t low = 0;
+  uint32_t high = static_cast<uint32_t>(tubeRing.size());
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+    if (tubeX(middle) <= x)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
 
 void managePhysics();
 
 void createPhysicsThread()
 {
+    initSnapshots();
+    sortTubeRing();
     std::thread physicsThread(managePhysics);
     physicsThread.detach();
 }
@@ -21,40 +79,40 @@ void resetEverything()
 {
   currentTime = 0.0f;
   score = 0;
-  uint32_t badId = 0;
-  for (auto& gameObject : gameObjects)
+  bodies.positionX[flappyBird] = 0.0f;
+  bodies.positionY[flappyBird] = 0.0f;
+  bodies.positionZ[flappyBird] = 10.0f;
+  bodies.velocityX[flappyBird] = 0.0f;
+  bodies.velocityY[flappyBird] = 0.0f;
+  bodies.velocityZ[flappyBird] = 0.0f;
+  bodies.rotationX[flappyBird] = 0.0f;
+  bodies.teleported[flappyBird] = true;
+
+  for (uint32_t i = 0; i < colliders.entities.size(); i++)
   {
-    if (gameObject.name.compare("FlappyBird") == 0)
-    {
-      gameObject.position = glm::vec3(0.0f, 0.0f, 10.0f);
-      gameObject.velocity = glm::vec3(0.0f);
-      gameObject.rotation.x = 0.0f;
-    }
-    if (gameObject.isBad == true)
-    {
-      gameObject.position = glm::vec3(
-          30.0f + static_cast<float>(badId) * (200.0f / numberOfTubes),
-          0.0f,
-          6.0f + 10.5f * 0.01f * static_cast<float>(rand() % 100));
-
-      gameObject.scale.z = 1.2f;
+    Entity tubes = colliders.entities[i];
+    bodies.positionX[tubes] = 30.0f + static_cast<float>(i) * (200.0f / numberOfTubes);
+    bodies.positionY[tubes] = 0.0f;
+    bodies.positionZ[tubes] = 6.0f + 10.5f * 0.01f * static_cast<float>(rand() % 100);
 
-      gameObject.isScored = false;
+    bodies.scaleZ[tubes] = 1.2f;
 
-      badId++;
-    }
+    bodies.teleported[tubes] = true;
   }
+  for (auto& scorable : scorables.components)
+    scorable.isScored = false;
+  sortTubeRing();
 }
 
 void jump()
 {
-  for (auto& gameObject : gameObjects)
-  {
-    if (gameObject.name.compare("FlappyBird") == 0)
-    {
-      gameObject.velocity.z = JUMP_SPEED;
-    }
-  }
+  jumpRequested.store(true, std::memory_order_relaxed);
+}
+
+// physics thread only
+void flap()
+{
+  bodies.velocityZ[flappyBird] = JUMP_SPEED;
 }
 
 void die()
@@ -67,12 +125,74 @@ void die()
   std::cout << "You Died! Score: " << score << ". Best Score: " << bestScore << "\n";
 }
 
+void updateTubes()
+{
+  float speed = -(7.2f + std::atan(currentTime * 0.01) * 2.4f);
+  for (Entity tubes : tubeRing)
+    bodies.velocityX[tubes] = speed;
+
+  while (!tubeRing.empty() && tubeX(0) <= TUBE_WRAP_X)
+  {
+    Entity tubes = tubeAt(0);
+    bodies.positionX[tubes] = TUBE_RESPAWN_X;
+    bodies.scaleZ[tubes] = 1.2f - 0.26f * std::atan((currentTime - 12.5) * 0.02);
+    bodies.positionZ[tubes] = 6.0f + 10.5f * 0.01f * static_cast<float>(rand() % 100);
+    bodies.teleported[tubes] = true;
+    if (struct Scorable* scorable = findComponent(scorables, tubes))
+      scorable->isScored = false;
+    tubeRingHead = (tubeRingHead + 1) % tubeRing.size();
+  }
+}
+
+void updateBird()
+{
+  Entity bird = flappyBird;
+  if (bodies.positionZ[bird] <= 1.1f)
+  {
+    die();
+    // bouncing instead of dying
+    //bodies.positionZ[bird] = 0.74f;
+    //if (bodies.velocityZ[bird] < 0.0f)
+    //{
+    //  bodies.velocityZ[bird] = -bodies.velocityZ[bird];
+    //}
+  }
+  bodies.rotationX[bird] = -std::atan(bodies.velocityZ[bird] / 48.0f) * 90.0f;
+
+  // the tubes that got past since the last tick, the ones before them are scored already
+  for (uint32_t position = findTube(TUBE_SCORE_X); position-- > 0;)
+  {
+    struct Scorable* scorable = findComponent(scorables, tubeAt(position));
+    if (scorable == NULL)
+      continue;
+    if (scorable->isScored)
+      break;
+    score++;
+    scorable->isScored = true;
+    std::cout << "score: " << score << "\n";
+  }
+
+  for (uint32_t position = findTube(TUBE_HIT_MIN_X); position < tubeRing.size() && tubeX(position) < TUBE_HIT_MAX_X; position++)
+  {
+    Entity tubes = tubeAt(position);
+    float gapHalfHeight = findComponent(colliders, tubes)->gapHalfHeight;
+    if (bodies.positionZ[bird] - bodies.positionZ[tubes] > gapHalfHeight * bodies.scaleZ[tubes] - 0.97f ||
+        bodies.positionZ[bird] - bodies.positionZ[tubes] < -gapHalfHeight * bodies.scaleZ[tubes] + 0.97f)
+    {
+      die();
+    }
+  }
+}
+
 void managePhysics()
 {
   using Framerate = std::chrono::duration<std::chrono::steady_clock::rep, std::ratio<1, PHYSICS_FPS>>;
   auto next = std::chrono::steady_clock::now() + Framerate{1};
+  uint64_t tick = 0;
   while (true)
   {
+    if (jumpRequested.exchange(false, std::memory_order_relaxed))
+      flap();
     if (currentTime > respawnTime && isGoing == false)
     {
       resetEverything();
@@ -83,67 +203,12 @@ void managePhysics()
       if (countDown == 3)
       {
         std::cout << "Start!\n";
-        jump();
+        flap();
         countDown++;
       }
-      for (auto& gameObject : gameObjects)
-      {
-        gameObject.rotation += gameObject.rotationSpeed;
-        gameObject.velocity += gameObject.accel;
-        gameObject.position += gameObject.velocity;
-
-        if (gameObject.name.compare("FlappyBird") == 0)
-        {
-          if (gameObject.position.z <= 1.1f)
-          {
-            die();
-            // bouncing instead of dying
-            //gameObject.position.z = 0.74f;
-            //if (gameObject.velocity.z < 0.0f)
-            //{
-            //  gameObject.velocity.z = -gameObject.velocity.z;
-            //}
-          }
-          gameObject.rotation.x = -std::atan(gameObject.velocity.z * 10.0f) * 90.0f;
-
-          for (auto& gameObject2 : gameObjects)
-          {
-            if (gameObject2.isBad == 1)
-            {
-              if (gameObject2.position.x <= -2.15f)
-              {
-                if (!gameObject2.isScored)
-                {
-                  score++;
-                  gameObject2.isScored = true;
-                  std::cout << "score: " << score << "\n";
-                }
-              }
-
-              if (gameObject2.position.x < 2.9f &&
-                  gameObject2.position.x > -2.32f)
-              {
-                if (gameObject.position.z - gameObject2.position.z > 3.57f * gameObject2.scale.z - 0.97f ||
-                    gameObject.position.z - gameObject2.position.z < -3.57f * gameObject2.scale.z + 0.97f)
-                {
-                  die();
-                }
-              }
-            }
-          }
-        }
-        else if (gameObject.isBad == true)
-        {
-          if (gameObject.position.x <= -40.0f)
-          {
-            gameObject.position.x = 160.0f;
-            gameObject.scale.z = 1.2f - 0.26f * std::atan((currentTime - 12.5) * 0.02);
-            gameObject.position.z = 6.0f + 10.5f * 0.01f * static_cast<float>(rand() % 100);
-            gameObject.isScored = false;
-          }
-          gameObject.velocity.x = -(0.015f + std::atan(currentTime * 0.01) * 0.005f);
-        }
-      }
+      integrateBodies(PHYSICS_STEP);
+      updateTubes();
+      updateBird();
     }
     else if (currentTime < 3.0)
     {
@@ -155,6 +220,8 @@ void managePhysics()
     }
 
     currentTime += (1.0 / static_cast<double>(PHYSICS_FPS));
+    // stamped with when the tick was due, not when it finished
+    publishSnapshot(++tick, std::chrono::time_point_cast<std::chrono::steady_clock::duration>(next - Framerate{1}));
 
     std::this_thread::sleep_until(next);
     next += Framerate{1};
@@ -0,0 +1,90 @@
+#include <atomic>
+
+// Physics -> render handoff. The physics thread is the only one touching
+// bodies. At the end of every tick it copies the transforms into the back
+// slot of a triple buffer and swaps that with the shared middle slot; once
+// per frame the renderer swaps its front slot with the middle one if a
+// newer tick is there. Each side only reads or writes the slot it holds,
+// so the renderer always sees one whole tick, never half of one, and
+// neither side takes a lock or waits for the other.
+//
+// Physics runs at a fixed PHYSICS_FPS below the frame rate. A snapshot also
+// carries the tick before it, and frames draw the state one tick in the
+// past, blended between the two by how far into the tick they are.
+
+struct PhysicsSnapshot {
+  uint64_t tick = 0;
+  std::chrono::steady_clock::time_point time; // when the tick was due
+  std::vector<struct ObjectTransform> previous; // the tick before
+  std::vector<struct ObjectTransform> transforms; // indexed by entity
+};
+
+// in snapshotMiddle next to the slot index, physics published since the last acquire
+const uint32_t SNAPSHOT_FRESH = 4;
+
+struct PhysicsSnapshot snapshots[3];
+uint32_t snapshotBack = 0; // physics thread only
+std::atomic<uint32_t> snapshotMiddle{1};
+uint32_t snapshotFront = 2; // render thread only
+std::vector<struct ObjectTransform> lastTransforms; // physics thread only, the last published tick
+
+void captureSnapshot(struct PhysicsSnapshot& snapshot, uint64_t tick, std::chrono::steady_clock::time_point time)
+{
+  snapshot.tick = tick;
+  snapshot.time = time;
+  snapshot.previous.resize(bodies.count);
+  snapshot.transforms.resize(bodies.count);
+  lastTransforms.resize(bodies.count);
+  for (Entity entity = 0; entity < bodies.count; entity++)
+  {
+    struct ObjectTransform transform = bodyTransform(entity);
+    snapshot.previous[entity] = bodies.teleported[entity] ? transform : lastTransforms[entity];
+    snapshot.transforms[entity] = transform;
+    lastTransforms[entity] = transform;
+    bodies.teleported[entity] = false;
+  }
+}
+
+// all three slots start out with the spawn positions, before the physics thread runs
+void initSnapshots()
+{
+  std::fill(bodies.teleported.begin(), bodies.teleported.end(), true);
+  for (auto& snapshot : snapshots)
+    captureSnapshot(snapshot, 0, std::chrono::steady_clock::now());
+}
+
+// physics thread, after a tick
+void publishSnapshot(uint64_t tick, std::chrono::steady_clock::time_point time)
+{
+  captureSnapshot(snapshots[snapshotBack], tick, time);
+  snapshotBack = snapshotMiddle.exchange(snapshotBack | SNAPSHOT_FRESH, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+}
+
+// render thread, once per frame, the result stays valid until the next call
+const struct PhysicsSnapshot& acquireSnapshot()
+{
+  if (snapshotMiddle.load(std::memory_order_relaxed) & SNAPSHOT_FRESH)
+    snapshotFront = snapshotMiddle.exchange(snapshotFront, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+  return snapshots[snapshotFront];
+}
+
+// the physics thread wakes a bit after a tick was due, frames in that gap
+// go on along the last step for up to this much of a tick instead of stopping
+const float MAX_EXTRAPOLATION = 0.25f;
+
+// the state one tick before now, between snapshot.previous and
+// snapshot.transforms, holds still when physics falls further behind
+void interpolateSnapshot(const struct PhysicsSnapshot& snapshot, std::vector<struct ObjectTransform>& out)
+{
+  std::chrono::duration<float> sinceTick = std::chrono::steady_clock::now() - snapshot.time;
+  float alpha = std::clamp(sinceTick.count() * static_cast<float>(PHYSICS_FPS), 0.0f, 1.0f + MAX_EXTRAPOLATION);
+  out.resize(snapshot.transforms.size());
+  for (size_t i = 0; i < snapshot.transforms.size(); i++)
+  {
+    const struct ObjectTransform& from = snapshot.previous[i];
+    const struct ObjectTransform& to = snapshot.transforms[i];
+    out[i].position = glm::mix(from.position, to.position, alpha);
+    out[i].rotation = glm::mix(from.rotation, to.rotation, alpha);
+    out[i].scale = glm::mix(from.scale, to.scale, alpha);
+  }
+}
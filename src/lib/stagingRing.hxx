@@ -0,0 +1,145 @@
+// Staging memory for the startup mesh uploads: one persistently mapped
+// buffer of STAGING_RING_KB split into STAGING_RING_CHUNKS chunks. Packing
+// writes straight into the current chunk, a full chunk is submitted with
+// its own fence and packing goes on in the next one while the GPU copies.
+// The ring only waits when it comes back around to a chunk whose copies
+// are still running, so staging never needs more than the ring no matter
+// how big a mesh is.
+
+const uint32_t STAGING_RING_CHUNKS = 4;
+
+struct StagingChunk {
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  VkFence fence = VK_NULL_HANDLE;
+  bool submitted = false;
+};
+
+struct StagingRing {
+  VkBuffer buffer = VK_NULL_HANDLE;
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  char* mapped = NULL;
+  VkDeviceSize chunkSize = 0;
+  struct StagingChunk chunks[STAGING_RING_CHUNKS];
+  uint32_t current = 0;
+  VkDeviceSize used = 0; // bytes of the current chunk already packed
+  bool recording = false;
+  uint32_t submitCount = 0;
+  uint32_t waitCount = 0; // times packing had to wait for a chunk
+};
+
+struct StagingRing stagingRing;
+
+void createStagingRing()
+{
+  stagingRing.chunkSize = static_cast<VkDeviceSize>(STAGING_RING_KB) * 1024 / STAGING_RING_CHUNKS;
+  VkDeviceSize ringSize = stagingRing.chunkSize * STAGING_RING_CHUNKS;
+  createBuffer(ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingRing.buffer, &stagingRing.memory);
+  vkMapMemory(device, stagingRing.memory, 0, ringSize, 0, reinterpret_cast<void**>(&stagingRing.mapped));
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  for (auto& chunk : stagingRing.chunks)
+  {
+    vkAllocateCommandBuffers(device, &allocInfo, &chunk.commandBuffer);
+    vkCreateFence(device, &fenceInfo, NULL, &chunk.fence);
+  }
+}
+
+// the current chunk takes copies again once its last ones are done
+void beginStagingChunk()
+{
+  struct StagingChunk& chunk = stagingRing.chunks[stagingRing.current];
+  if (chunk.submitted)
+  {
+    if (vkGetFenceStatus(device, chunk.fence) != VK_SUCCESS)
+    {
+      stagingRing.waitCount++;
+      vkWaitForFences(device, 1, &chunk.fence, VK_TRUE, UINT64_MAX);
+    }
+    vkResetFences(device, 1, &chunk.fence);
+    chunk.submitted = false;
+  }
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(chunk.commandBuffer, &beginInfo);
+  stagingRing.used = 0;
+  stagingRing.recording = true;
+}
+
+// hands the packed part of the current chunk to the GPU, also when it's
+// not full and there's nothing else to pack right now
+void submitStagingChunk()
+{
+  if (!stagingRing.recording)
+    return;
+  struct StagingChunk& chunk = stagingRing.chunks[stagingRing.current];
+  vkEndCommandBuffer(chunk.commandBuffer);
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &chunk.commandBuffer;
+  if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, chunk.fence) != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to submit staging chunk\n");
+    exit(-1);
+  }
+  chunk.submitted = true;
+  stagingRing.recording = false;
+  stagingRing.current = (stagingRing.current + 1) % STAGING_RING_CHUNKS;
+  stagingRing.submitCount++;
+}
+
+// Copies elementCount elements of elementSize bytes into dst. pack(first,
+// count, out) writes elements first..first+count-1 to out, which is ring
+// memory, as many as fit in the current chunk at a time.
+void stageBufferUpload(VkBuffer dst, uint32_t elementCount, VkDeviceSize elementSize,
+    const std::function<void(uint32_t, uint32_t, char*)>& pack)
+{
+  uint32_t done = 0;
+  while (done < elementCount)
+  {
+    if (!stagingRing.recording)
+      beginStagingChunk();
+    VkDeviceSize fits = (stagingRing.chunkSize - stagingRing.used) / elementSize;
+    if (fits == 0)
+    {
+      submitStagingChunk();
+      continue;
+    }
+    uint32_t count = static_cast<uint32_t>(std::min<VkDeviceSize>(fits, elementCount - done));
+    VkDeviceSize offset = stagingRing.current * stagingRing.chunkSize + stagingRing.used;
+    pack(done, count, stagingRing.mapped + offset);
+
+    VkBufferCopy copy = {};
+    copy.srcOffset = offset;
+    copy.dstOffset = done * elementSize;
+    copy.size = count * elementSize;
+    vkCmdCopyBuffer(stagingRing.chunks[stagingRing.current].commandBuffer, stagingRing.buffer, dst, 1, &copy);
+    stagingRing.used += copy.size;
+    done += count;
+  }
+}
+
+// submits what's left and waits for all copies, then the ring goes away
+void destroyStagingRing()
+{
+  submitStagingChunk();
+  for (auto& chunk : stagingRing.chunks)
+  {
+    if (chunk.submitted)
+      vkWaitForFences(device, 1, &chunk.fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(device, chunk.fence, NULL);
+    vkFreeCommandBuffers(device, commandPool, 1, &chunk.commandBuffer);
+  }
+  vkDestroyBuffer(device, stagingRing.buffer, NULL);
+  vkFreeMemory(device, stagingRing.memory, NULL);
+  stagingRing = StagingRing();
+}
@@ -0,0 +1,632 @@
+// Texture manager. Textures are the KTX2 files from lib/compileTextures,
+// they stay mapped (in the asset pack or loose) for the whole run and only
+// the mip levels the screen needs are in GPU memory:
+//  - updateSceneUniformBuffer reports how many pixels every object covers,
+//    that gives the finest level worth having (requestTextureLevel)
+//  - updateTextureStreaming streams finer levels in once per frame, and
+//    when the total goes over TEXTURE_BUDGET_MB it drops the fine levels of
+//    the least recently used textures first
+//  - levels are copied into a staging buffer on the asset pool, the copy
+//    into the image is submitted with a fence that's never waited on
+// Without sparse binding an image can't be partially resident, so the image
+// of a texture only holds levels residentLevel..levelCount-1 and gets
+// recreated when that range changes, the levels it keeps are copied over on
+// the GPU. A jpg/png without compiled files is decoded and uploaded whole.
+
+// uploads in flight at once, each one holds a staging buffer
+const uint32_t maxTextureUploads = 2;
+
+// decoded on the asset pool while the device gets set up. When
+// lib/compileTextures output is around (compiled set) nothing gets decoded,
+// createTextures picks one of the KTX2 files and streams it from there.
+struct TextureFile {
+  std::string path;
+  bool compiled = false;
+  stbi_uc* pixels = NULL;
+  int width = 0;
+  int height = 0;
+};
+
+// a residency change, from startTextureUpload until the fence signals
+struct TextureUpload {
+  uint32_t firstLevel = 0;
+  std::shared_future<void> staged; // not valid when nothing comes from the file
+  VkBuffer stagingBuffer = VK_NULL_HANDLE;
+  VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+  std::vector<VkBufferImageCopy> regions;
+  VkImage image = VK_NULL_HANDLE;
+  VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  VkFence fence = VK_NULL_HANDLE;
+};
+
+struct StreamedTexture {
+  struct TextureFile file;
+  std::shared_future<void> loaded;
+
+  // the KTX2 file, not mapped for a decoded jpg/png
+  struct MappedFile ktx2;
+  std::vector<struct Ktx2Level> levels;
+  VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t levelCount = 0;
+
+  VkImage image = VK_NULL_HANDLE;
+  VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+  VkImageView view = VK_NULL_HANDLE;
+  uint32_t residentLevel = 0; // finest level in the image, its mip 0
+  uint32_t tailLevel = 0; // levels from here on are never evicted
+  uint32_t wantedLevel = 0; // finest level any object asked for this frame
+  uint64_t lastUsedFrame = 0;
+
+  bool uploading = false;
+  struct TextureUpload upload;
+};
+
+// Renderable::texture and Material::texture index into it. Only grows in
+// registerMaterialTextures while nothing is loading, the asset pool holds
+// pointers into it.
+std::vector<struct StreamedTexture> textures;
+uint64_t streamingFrame = 0;
+
+uint32_t mipExtent(uint32_t size, uint32_t level)
+{
+  return std::max(1u, size >> level);
+}
+
+// GPU memory for levels firstLevel..levelCount-1, without alignment
+VkDeviceSize textureBytes(const struct StreamedTexture& texture, uint32_t firstLevel)
+{
+  VkDeviceSize bytes = 0;
+  for (uint32_t level = firstLevel; level < texture.levelCount; level++)
+    bytes += ktx2LevelBytes(static_cast<uint32_t>(texture.format), mipExtent(texture.width, level), mipExtent(texture.height, level));
+  return bytes;
+}
+
+bool isStreamed(const struct StreamedTexture& texture)
+{
+  return TEXTURE_STREAMING == 1 && texture.ktx2.data != NULL;
+}
+
+// "textures/statue.jpg" -> "textures/statue.bc7.ktx2"
+std::string compiledTexturePath(const std::string& path, const char* suffix)
+{
+  return path.substr(0, path.find_last_of('.')) + suffix;
+}
+
+void decodeTextureFile(struct TextureFile& textureFile)
+{
+  struct MappedFile file;
+  if (!openAsset(textureFile.path, file))
+    return; // reported by createDecodedTexture
+  int texChannels;
+  textureFile.pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data), static_cast<int>(file.size),
+      &textureFile.width, &textureFile.height, &texChannels, STBI_rgb_alpha);
+  unmapFile(file);
+}
+
+void submitTextureLoad(struct StreamedTexture& texture)
+{
+  struct TextureFile* target = &texture.file;
+  texture.loaded = assetPool.submit([target]() {
+    struct MappedFile file;
+    if (openAsset(compiledTexturePath(target->path, ".rgba8.ktx2"), file))
+    {
+      unmapFile(file);
+      target->compiled = true;
+      return;
+    }
+    decodeTextureFile(*target);
+  });
+}
+
+void loadTextures()
+{
+  const char* texturePaths[] = { "textures/statue.jpg" };
+  textures.resize(sizeof(texturePaths) / sizeof(texturePaths[0]));
+  for (size_t i = 0; i < textures.size(); i++)
+  {
+    textures[i].file.path = texturePaths[i];
+    submitTextureLoad(textures[i]);
+  }
+}
+
+// index of the texture loaded from path, NO_TEXTURE when there's none
+uint32_t findTexture(const std::string& path)
+{
+  for (uint32_t i = 0; i < textures.size(); i++)
+    if (textures[i].file.path == path)
+      return i;
+  return NO_TEXTURE;
+}
+
+// map_Kd textures are only known once the .mtl files are read, they get
+// appended here and Material::texture is set. Materials sharing a map
+// share the texture.
+void registerMaterialTextures()
+{
+  for (auto& texture : textures)
+    waitForAsset(texture.loaded, texture.file.path);
+
+  size_t firstNew = textures.size();
+  for (auto& model : Models)
+  {
+    waitForAsset(model.second.loaded, model.second.objPath);
+    for (auto& material : model.second.materials)
+    {
+      if (material.diffuseMap.empty())
+        continue;
+      material.texture = findTexture(material.diffuseMap);
+      if (material.texture == NO_TEXTURE)
+      {
+        material.texture = static_cast<uint32_t>(textures.size());
+        textures.emplace_back();
+        textures.back().file.path = material.diffuseMap;
+      }
+    }
+  }
+  if (firstNew < textures.size() && !descriptorIndexing)
+    printf("\033[33mWARN:\033[0m Material textures need descriptor indexing, they are loaded but not drawn\n");
+
+  for (size_t i = firstNew; i < textures.size(); i++)
+    submitTextureLoad(textures[i]);
+}
+
+// Maps the first KTX2 file the device can sample: BC7, then ETC2, then
+// RGBA8, and checks its level table. Nothing is uploaded yet.
+bool openCompiledTexture(struct StreamedTexture& texture)
+{
+  struct Candidate {
+    VkFormat format;
+    const char* suffix;
+    bool supported;
+  };
+  const struct Candidate candidates[] = {
+    { VK_FORMAT_BC7_SRGB_BLOCK, ".bc7.ktx2", textureCompressionBC },
+    { VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, ".etc2.ktx2", textureCompressionETC2 },
+    { VK_FORMAT_R8G8B8A8_SRGB, ".rgba8.ktx2", true },
+  };
+
+  for (const auto& candidate : candidates)
+  {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, candidate.format, &formatProperties);
+    VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+      VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    if (!candidate.supported || (formatProperties.optimalTilingFeatures & needed) != needed)
+      continue;
+
+    std::string path = compiledTexturePath(texture.file.path, candidate.suffix);
+    struct MappedFile file;
+    if (!openAsset(path, file))
+      continue;
+
+    struct Ktx2Header header;
+    std::vector<struct Ktx2Level> levels;
+    bool valid = file.size >= sizeof(header);
+    if (valid)
+    {
+      memcpy(&header, file.data, sizeof(header));
+      valid = memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 &&
+        header.vkFormat == static_cast<uint32_t>(candidate.format) &&
+        header.pixelWidth > 0 && header.pixelHeight > 0 && header.pixelDepth == 0 &&
+        header.layerCount == 0 && header.faceCount == 1 && header.supercompressionScheme == 0 &&
+        header.levelCount > 0 && header.levelCount <= 32 &&
+        sizeof(header) + header.levelCount * sizeof(struct Ktx2Level) <= file.size;
+    }
+    for (uint32_t i = 0; valid && i < header.levelCount; i++)
+    {
+      struct Ktx2Level level;
+      memcpy(&level, file.data + sizeof(header) + i * sizeof(level), sizeof(level));
+      valid = level.byteLength == ktx2LevelBytes(header.vkFormat, mipExtent(header.pixelWidth, i), mipExtent(header.pixelHeight, i)) &&
+        level.byteOffset + level.byteLength <= file.size;
+      levels.push_back(level);
+    }
+    if (!valid)
+    {
+      printf("\033[33mWARN:\033[0m \"%s\" isn't a usable KTX2 file, skipping\n", path.c_str());
+      unmapFile(file);
+      continue;
+    }
+
+    texture.ktx2 = file;
+    texture.levels = levels;
+    texture.format = candidate.format;
+    texture.width = header.pixelWidth;
+    texture.height = header.pixelHeight;
+    texture.levelCount = header.levelCount;
+    texture.tailLevel = 0;
+    while (texture.tailLevel + 1 < texture.levelCount &&
+        std::max(mipExtent(texture.width, texture.tailLevel), mipExtent(texture.height, texture.tailLevel)) > TEXTURE_MIP_TAIL)
+      texture.tailLevel++;
+    printf("Texture \"%s\": %ux%u, %u levels, %.2f MB with all of them\n", path.c_str(), texture.width, texture.height,
+        texture.levelCount, static_cast<double>(textureBytes(texture, 0)) / (1024.0 * 1024.0));
+    return true;
+  }
+  return false;
+}
+
+// runs on the asset pool, copies the levels from firstLevel up to endLevel
+// out of the mapping into one staging buffer, one copy region each
+void stageTextureLevels(struct StreamedTexture& texture, uint32_t endLevel)
+{
+  struct TextureUpload& upload = texture.upload;
+  VkDeviceSize stagingSize = 0;
+  for (uint32_t level = upload.firstLevel; level < endLevel; level++)
+  {
+    VkBufferImageCopy region = {};
+    region.bufferOffset = stagingSize;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level - upload.firstLevel;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = { mipExtent(texture.width, level), mipExtent(texture.height, level), 1 };
+    upload.regions.push_back(region);
+    // keeps every region on a block boundary
+    stagingSize += (texture.levels[level].byteLength + 15) & ~static_cast<VkDeviceSize>(15);
+  }
+
+  createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &upload.stagingBuffer, &upload.stagingBufferMemory);
+  char* data;
+  vkMapMemory(device, upload.stagingBufferMemory, 0, stagingSize, 0, reinterpret_cast<void**>(&data));
+  for (uint32_t level = upload.firstLevel; level < endLevel; level++)
+  {
+    const struct Ktx2Level& source = texture.levels[level];
+    memcpy(data + upload.regions[level - upload.firstLevel].bufferOffset, texture.ktx2.data + source.byteOffset, source.byteLength);
+  }
+  vkUnmapMemory(device, upload.stagingBufferMemory);
+}
+
+// new residency starting at firstLevel. Levels the current image doesn't
+// have get staged in the background, coarser ones are copied from it.
+void startTextureUpload(struct StreamedTexture& texture, uint32_t firstLevel)
+{
+  texture.uploading = true;
+  texture.upload = TextureUpload();
+  texture.upload.firstLevel = firstLevel;
+  uint32_t endLevel = texture.image == VK_NULL_HANDLE ? texture.levelCount : std::max(firstLevel, texture.residentLevel);
+  if (endLevel > firstLevel)
+  {
+    struct StreamedTexture* target = &texture;
+    texture.upload.staged = assetPool.submit([target, endLevel]() { stageTextureLevels(*target, endLevel); });
+  }
+}
+
+bool isStaged(const struct TextureUpload& upload)
+{
+  return !upload.staged.valid() || upload.staged.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+VkImageMemoryBarrier textureBarrier(VkImage image, uint32_t levelCount, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask = srcAccessMask;
+  barrier.dstAccessMask = dstAccessMask;
+  barrier.oldLayout = oldLayout;
+  barrier.newLayout = newLayout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = levelCount;
+  barrier.subresourceRange.layerCount = 1;
+  return barrier;
+}
+
+// Records the new image's uploads and submits them with the upload's
+// fence. The old image stays bound and sampled until finishTextureUpload,
+// it goes back to SHADER_READ_ONLY in the same command buffer.
+void submitTextureUpload(struct StreamedTexture& texture)
+{
+  struct TextureUpload& upload = texture.upload;
+  uint32_t levelCount = texture.levelCount - upload.firstLevel;
+  uint32_t oldLevelCount = texture.levelCount - texture.residentLevel;
+  bool hasOld = texture.image != VK_NULL_HANDLE;
+  createImage(mipExtent(texture.width, upload.firstLevel), mipExtent(texture.height, upload.firstLevel), levelCount,
+      VK_SAMPLE_COUNT_1_BIT, texture.format, VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &upload.image, &upload.imageMemory);
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+  vkAllocateCommandBuffers(device, &allocInfo, &upload.commandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(upload.commandBuffer, &beginInfo);
+
+  VkImageMemoryBarrier toTransfer[2] = {
+    textureBarrier(upload.image, levelCount, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL),
+    textureBarrier(texture.image, oldLevelCount, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL),
+  };
+  vkCmdPipelineBarrier(upload.commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+      0, NULL, 0, NULL, hasOld ? 2 : 1, toTransfer);
+
+  if (!upload.regions.empty())
+    vkCmdCopyBufferToImage(upload.commandBuffer, upload.stagingBuffer, upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(upload.regions.size()), upload.regions.data());
+
+  if (hasOld)
+  {
+    std::vector<VkImageCopy> copies;
+    for (uint32_t level = std::max(upload.firstLevel, texture.residentLevel); level < texture.levelCount; level++)
+    {
+      VkImageCopy copy = {};
+      copy.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - texture.residentLevel, 0, 1 };
+      copy.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - upload.firstLevel, 0, 1 };
+      copy.extent = { mipExtent(texture.width, level), mipExtent(texture.height, level), 1 };
+      copies.push_back(copy);
+    }
+    vkCmdCopyImage(upload.commandBuffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, upload.image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+  }
+
+  VkImageMemoryBarrier toShader[2] = {
+    textureBarrier(upload.image, levelCount, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+    textureBarrier(texture.image, oldLevelCount, 0, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+  };
+  vkCmdPipelineBarrier(upload.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+      0, NULL, 0, NULL, hasOld ? 2 : 1, toShader);
+  vkEndCommandBuffer(upload.commandBuffer);
+
+  VkFenceCreateInfo fenceInfo = {};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  vkCreateFence(device, &fenceInfo, NULL, &upload.fence);
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &upload.commandBuffer;
+  if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, upload.fence) != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to submit texture upload\n");
+    exit(-1);
+  }
+}
+
+void writeTextureDescriptors(uint32_t texture);
+
+// the upload's fence has signaled, the new image replaces the old one
+void finishTextureUpload(struct StreamedTexture& texture, uint32_t index)
+{
+  struct TextureUpload& upload = texture.upload;
+  vkDestroyFence(device, upload.fence, NULL);
+  vkFreeCommandBuffers(device, commandPool, 1, &upload.commandBuffer);
+  if (upload.stagingBuffer != VK_NULL_HANDLE)
+  {
+    vkDestroyBuffer(device, upload.stagingBuffer, NULL);
+    vkFreeMemory(device, upload.stagingBufferMemory, NULL);
+  }
+  if (texture.image != VK_NULL_HANDLE)
+  {
+    vkDestroyImageView(device, texture.view, NULL);
+    vkDestroyImage(device, texture.image, NULL);
+    vkFreeMemory(device, texture.imageMemory, NULL);
+  }
+
+  uint32_t oldLevel = texture.residentLevel;
+  bool first = texture.image == VK_NULL_HANDLE;
+  texture.image = upload.image;
+  texture.imageMemory = upload.imageMemory;
+  texture.residentLevel = upload.firstLevel;
+  texture.view = createImageView(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.levelCount - texture.residentLevel);
+  texture.upload = TextureUpload();
+  texture.uploading = false;
+  writeTextureDescriptors(index);
+
+  if (first)
+    printf("  \"%s\" starts with %ux%u, %.2f MB\n", texture.file.path.c_str(),
+        mipExtent(texture.width, texture.residentLevel), mipExtent(texture.height, texture.residentLevel),
+        static_cast<double>(textureBytes(texture, texture.residentLevel)) / (1024.0 * 1024.0));
+  else
+    printf("  \"%s\" %s to %ux%u, %.2f MB\n", texture.file.path.c_str(), texture.residentLevel < oldLevel ? "streamed in" : "evicted",
+        mipExtent(texture.width, texture.residentLevel), mipExtent(texture.height, texture.residentLevel),
+        static_cast<double>(textureBytes(texture, texture.residentLevel)) / (1024.0 * 1024.0));
+}
+
+// decodes on the main thread when the compiled files weren't usable,
+// uploads the whole image and builds the mip chain with blits
+void createDecodedTexture(struct StreamedTexture& texture)
+{
+  if (texture.file.compiled)
+    decodeTextureFile(texture.file);
+  int texWidth = texture.file.width;
+  int texHeight = texture.file.height;
+  stbi_uc* pixels = texture.file.pixels;
+  texture.file.pixels = NULL;
+  VkDeviceSize imageSize = texWidth * texHeight * 4;
+
+  if (!pixels) {
+		printf("\033[31mERR:\033[0m Failed to load texture image \"%s\"\n", texture.file.path.c_str());
+		exit(-1);
+  }
+
+  texture.format = VK_FORMAT_R8G8B8A8_SRGB;
+  texture.width = static_cast<uint32_t>(texWidth);
+  texture.height = static_cast<uint32_t>(texHeight);
+  texture.levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+
+  VkBuffer stagingBuffer;
+  VkDeviceMemory stagingBufferMemory;
+  createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+
+  void* data;
+  vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+  memcpy(data, pixels, (size_t)imageSize);
+  vkUnmapMemory(device, stagingBufferMemory);
+
+  stbi_image_free(pixels);
+
+  createImage(texWidth, texHeight, texture.levelCount, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &texture.image, &texture.imageMemory);
+
+  transitionImageLayout(texture.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, texture.levelCount);
+  copyBufferToImage(stagingBuffer, texture.image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+
+  generateMipmaps(texture.image, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, texture.levelCount);
+
+  vkDestroyBuffer(device, stagingBuffer, nullptr);
+  vkFreeMemory(device, stagingBufferMemory, nullptr);
+
+  texture.view = createImageView(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.levelCount);
+}
+
+// Only the mip tail goes up front when streaming, that's a few KB per
+// texture. All staging runs in parallel, then one wait for the copies.
+void createTextures()
+{
+  registerMaterialTextures();
+  for (auto& texture : textures)
+  {
+    waitForAsset(texture.loaded, texture.file.path);
+    if (texture.file.compiled && openCompiledTexture(texture))
+      startTextureUpload(texture, isStreamed(texture) ? texture.tailLevel : 0);
+    else
+      createDecodedTexture(texture);
+  }
+  for (auto& texture : textures)
+  {
+    if (!texture.uploading)
+      continue;
+    if (texture.upload.staged.valid())
+      texture.upload.staged.wait();
+    submitTextureUpload(texture);
+  }
+  for (uint32_t i = 0; i < textures.size(); i++)
+  {
+    if (!textures[i].uploading)
+      continue;
+    vkWaitForFences(device, 1, &textures[i].upload.fence, VK_TRUE, UINT64_MAX);
+    finishTextureUpload(textures[i], i);
+    if (!isStreamed(textures[i]))
+      unmapFile(textures[i].ktx2); // everything is resident
+  }
+  for (auto& texture : textures)
+    texture.wantedLevel = texture.residentLevel;
+}
+
+// called for every object drawn with the texture, projectedPixels is how
+// many pixels its largest extent covers on screen
+void requestTextureLevel(uint32_t index, float projectedPixels)
+{
+  if (index >= textures.size())
+    return;
+  struct StreamedTexture& texture = textures[index];
+  texture.lastUsedFrame = streamingFrame;
+  float texels = static_cast<float>(std::max(texture.width, texture.height));
+  uint32_t level = 0;
+  // one texel per pixel is enough, anything finer would be minified away
+  if (projectedPixels < texels)
+    level = static_cast<uint32_t>(std::floor(std::log2(texels / std::max(projectedPixels, 1.0f))));
+  texture.wantedLevel = std::min({ texture.wantedLevel, level, texture.levelCount - 1 });
+}
+
+// Once per frame before recording. drawFrame waits for the queue to go
+// idle after every submit, so whatever the last frame sampled is free here.
+void updateTextureStreaming()
+{
+  if (TEXTURE_STREAMING != 1)
+    return;
+
+  uint32_t uploadsInFlight = 0;
+  for (uint32_t i = 0; i < textures.size(); i++)
+  {
+    struct StreamedTexture& texture = textures[i];
+    if (!texture.uploading)
+      continue;
+    if (texture.upload.fence == VK_NULL_HANDLE)
+    {
+      if (isStaged(texture.upload))
+        submitTextureUpload(texture);
+      uploadsInFlight++;
+    }
+    else if (vkGetFenceStatus(device, texture.upload.fence) == VK_SUCCESS)
+      finishTextureUpload(texture, i);
+    else
+      uploadsInFlight++;
+  }
+
+  // levels already resident stay until the budget needs them
+  std::vector<uint32_t> targetLevels(textures.size());
+  VkDeviceSize totalBytes = 0;
+  for (uint32_t i = 0; i < textures.size(); i++)
+  {
+    const struct StreamedTexture& texture = textures[i];
+    targetLevels[i] = isStreamed(texture) ? std::min(texture.wantedLevel, texture.residentLevel) : texture.residentLevel;
+    totalBytes += textureBytes(texture, targetLevels[i]);
+  }
+
+  // over budget: the least recently used textures lose their fine levels
+  // first, down to the mip tail
+  const VkDeviceSize budget = static_cast<VkDeviceSize>(TEXTURE_BUDGET_MB) * 1024 * 1024;
+  if (totalBytes > budget)
+  {
+    std::vector<uint32_t> leastRecentlyUsed(textures.size());
+    for (uint32_t i = 0; i < textures.size(); i++)
+      leastRecentlyUsed[i] = i;
+    std::sort(leastRecentlyUsed.begin(), leastRecentlyUsed.end(), [](uint32_t a, uint32_t b) {
+      return textures[a].lastUsedFrame < textures[b].lastUsedFrame;
+    });
+    for (uint32_t i : leastRecentlyUsed)
+    {
+      const struct StreamedTexture& texture = textures[i];
+      while (totalBytes > budget && isStreamed(texture) && targetLevels[i] < texture.tailLevel)
+      {
+        totalBytes -= textureBytes(texture, targetLevels[i]) - textureBytes(texture, targetLevels[i] + 1);
+        targetLevels[i]++;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < textures.size() && uploadsInFlight < maxTextureUploads; i++)
+  {
+    struct StreamedTexture& texture = textures[i];
+    if (!isStreamed(texture) || texture.uploading || targetLevels[i] == texture.residentLevel)
+      continue;
+    startTextureUpload(texture, targetLevels[i]);
+    uploadsInFlight++;
+  }
+
+  for (auto& texture : textures)
+    texture.wantedLevel = texture.levelCount - 1;
+  streamingFrame++;
+}
+
+// after vkDeviceWaitIdle
+void destroyTextures()
+{
+  for (auto& texture : textures)
+  {
+    if (texture.uploading)
+    {
+      if (texture.upload.staged.valid())
+        texture.upload.staged.wait();
+      if (texture.upload.stagingBuffer != VK_NULL_HANDLE)
+      {
+        vkDestroyBuffer(device, texture.upload.stagingBuffer, NULL);
+        vkFreeMemory(device, texture.upload.stagingBufferMemory, NULL);
+      }
+      if (texture.upload.fence != VK_NULL_HANDLE)
+      {
+        vkDestroyFence(device, texture.upload.fence, NULL);
+        vkFreeCommandBuffers(device, commandPool, 1, &texture.upload.commandBuffer);
+        vkDestroyImage(device, texture.upload.image, NULL);
+        vkFreeMemory(device, texture.upload.imageMemory, NULL);
+      }
+    }
+    vkDestroyImageView(device, texture.view, NULL);
+    vkDestroyImage(device, texture.image, NULL);
+    vkFreeMemory(device, texture.imageMemory, NULL);
+    unmapFile(texture.ktx2);
+  }
+  textures.clear();
+}
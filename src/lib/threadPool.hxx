@@ -0,0 +1,56 @@
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+
+// Small pool for load time jobs. The workers are detached like the physics
+// thread and live until the process exits, so the pool is never destroyed.
+struct ThreadPool {
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::queue<std::function<void()>> tasks;
+  bool started = false;
+
+  void start()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (started)
+      return;
+    started = true;
+    // the main thread keeps going with Vulkan setup, so at least one worker
+    // even on single core machines, file reads still overlap with it
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < threadCount; i++)
+      std::thread(&ThreadPool::work, this).detach();
+  }
+
+  std::shared_future<void> submit(std::function<void()> task)
+  {
+    start();
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::shared_future<void> done = packaged->get_future().share();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push([packaged]() { (*packaged)(); });
+    }
+    wake.notify_one();
+    return done;
+  }
+
+  void work()
+  {
+    for (;;)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this]() { return !tasks.empty(); });
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+};
+
+struct ThreadPool& assetPool = *new ThreadPool();
@@ -25,6 +25,59 @@ const char* deviceExtensions[DEVICE_EXTENSION_COUNT] = {
 
 VkSwapchainKHR swapChain;
 
+// headless mode: no window, surface or swap chain. Frames go into offscreen
+// images that stand in for the swap chain images, for CI boxes without a display
+bool headless = HEADLESS == 1;
+uint32_t headlessFrameCount = HEADLESS_FRAMES;
+VkDeviceMemory* offscreenImageMemories;
+// layout the frame is left in at the end of the command buffer
+VkImageLayout presentLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+// Vulkan 1.3 path: vkCmdBeginRendering + vkCmdPipelineBarrier2 instead of
+// render passes and framebuffers. Stays false on older drivers.
+uint32_t instanceApiVersion = VK_API_VERSION_1_0;
+bool useDynamicRendering = false;
+PFN_vkCmdBeginRendering pfnCmdBeginRendering = NULL;
+PFN_vkCmdEndRendering pfnCmdEndRendering = NULL;
+PFN_vkCmdPipelineBarrier2 pfnCmdPipelineBarrier2 = NULL;
+PFN_vkCmdWriteTimestamp2 pfnCmdWriteTimestamp2 = NULL;
+
+// Bindless textures: all of them sit in one array in descriptor set 1 and
+// every draw picks its own with a push constant, so more textures don't
+// mean more descriptor sets or binds. With descriptor indexing the array is
+// partially bound and update after bind: it can be as big as the device
+// allows and streaming swaps images in without waiting for the GPU. Without
+// it every slot has to be written and the plain sampler limits apply.
+bool descriptorIndexing = false;
+// VK_EXT_descriptor_indexing on a Vulkan 1.1 device, core from 1.2
+bool descriptorIndexingExtension = false;
+uint32_t textureArraySize = 1; // TEXTURE_ARRAY_SIZE in objectShader.frag
+VkDescriptorSetLayout textureDescriptorSetLayout;
+VkDescriptorPool textureDescriptorPool;
+VkDescriptorSet textureDescriptorSet = VK_NULL_HANDLE;
+
+struct DrawConstants
+{
+  uint32_t textureIndex; // NO_TEXTURE draws with the material color only
+  uint32_t firstMaterial; // Model::firstMaterial, vertex materials are relative to it
+};
+
+// Every model's materials back to back, read by objectShader.frag from set 1
+// binding 1. Host visible, so recoloring is a writeMaterial and no mesh or
+// pipeline changes.
+struct GpuMaterial
+{
+  alignas(16) glm::vec4 diffuse;
+  alignas(16) glm::vec4 specular; // a = shininess
+  uint32_t texture; // NO_TEXTURE or an index into textures
+  uint32_t padding[3];
+};
+std::vector<struct GpuMaterial> materialTable;
+VkBuffer materialBuffer;
+VkDeviceMemory materialBufferMemory;
+VkDeviceSize materialBufferSize = 0;
+void* materialBufferMapped;
+
 // glm stuff
 struct SceneUBO
 {
@@ -34,7 +87,6 @@ struct SceneUBO
 	alignas(16) glm::mat4 normalMatrix;
 	alignas(16) glm::mat4 normalViewMatrix;
 	alignas(16) glm::mat4 lightSpaceMatrix;
-  alignas(16) glm::vec3 materialSpecular; 
 	alignas(16) glm::vec3 lightDir;
 	alignas(16) glm::vec3 viewPos;
   alignas(16) glm::vec3 shadowMapResolution;
@@ -84,6 +136,14 @@ VkDescriptorSetLayout shadowMapDescriptorSetLayout;
 VkDescriptorSetLayout descriptorSetLayout;
 VkPipelineLayout objectPipelineLayout;
 VkPipeline objectGraphicsPipeline;
+// optional depth pre-pass: depth only draw of everything, then the color
+// pass with an EQUAL depth test so every pixel runs the PCF shader once
+bool depthPrePass = DEPTH_PRE_PASS == 1;
+VkPipeline depthPrePassGraphicsPipeline;
+VkPipeline objectEqualGraphicsPipeline;
+// overdraw measurement, counts fragment shader invocations of the color pass
+bool measureOverdraw = MEASURE_OVERDRAW == 1;
+VkQueryPool overdrawQueryPool = VK_NULL_HANDLE;
 VkPipelineLayout shadowMapPipelineLayout;
 VkPipeline shadowMapGraphicsPipeline;
 
@@ -111,12 +171,23 @@ static void framebufferResizeCallback();
 
 uint32_t currentFrame = 0;
 
-uint32_t mipLevels;
+// enabled in createLogicalDevice when the device has them
+bool textureCompressionBC = false;
+bool textureCompressionETC2 = false;
 
-VkImage textureImage;
-VkDeviceMemory textureImageMemory;
+// for the time to first frame report
+auto launchTime = std::chrono::steady_clock::now();
+bool firstFramePresented = false;
+
+void reportFirstFrame()
+{
+  if (firstFramePresented)
+    return;
+  firstFramePresented = true;
+  std::chrono::duration<double, std::milli> sinceLaunch = std::chrono::steady_clock::now() - launchTime;
+  printf("First frame done %.2f ms after launch\n", sinceLaunch.count());
+}
 
-VkImageView textureImageView;
 VkSampler textureSampler;
 
 VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
@@ -144,6 +215,22 @@ VkImage depthImage;
 VkDeviceMemory depthImageMemory;
 VkImageView depthImageView;
 
+// offscreen scene target for dynamic resolution: the main pass resolves into
+// the top left renderExtent of it, then it gets blitted to the swap chain image
+bool useDynamicResolution = false;
+float renderScale = 1.0f;
+VkExtent2D renderExtent;
+// The scale follows the GPU time of the frame, two timestamps per frame in
+// flight around the shadow and main pass. Needs timestamp support on the
+// graphics queue, without it the resolution stays fixed.
+bool gpuTimestamps = false;
+float timestampPeriod = 1.0f; // nanoseconds per tick
+uint64_t timestampMask = 0xFFFFFFFFFFFFFFFF; // timestampValidBits of the graphics queue
+VkQueryPool timestampQueryPool = VK_NULL_HANDLE;
+VkImage sceneImage;
+VkDeviceMemory sceneImageMemory;
+VkImageView sceneImageView;
+
 void cleanResources()
 {
   vkDestroyImageView(device, colorImageView, NULL);
@@ -157,6 +244,13 @@ void cleanResources()
   vkDestroyImageView(device, depthImageView, NULL);
   vkDestroyImage(device, depthImage, NULL);
   vkFreeMemory(device, depthImageMemory, NULL);
+
+  if (useDynamicResolution)
+  {
+    vkDestroyImageView(device, sceneImageView, NULL);
+    vkDestroyImage(device, sceneImage, NULL);
+    vkFreeMemory(device, sceneImageMemory, NULL);
+  }
 }
 
 struct SwapChainSupportDetails
@@ -259,12 +353,20 @@ void initVulkan();
 void Cleanup();
 
 void loadModels();
+void loadTextures();
 void createObjects();
 
 void Run()
 {
-	initWindow();
+  launchTime = std::chrono::steady_clock::now();
+  openAssetPack(ASSET_PACK_FILE);
+  openEmbeddedAssets();
+  // asset loads run on the pool while the window, device and pipelines get
+  // created, uploads only wait for the assets they need
   loadModels();
+  loadTextures();
+  if (!headless)
+    initWindow();
   createObjects();
 	initVulkan();
 	Cleanup();
@@ -275,6 +377,7 @@ void createSurface();
 void pickPhysicalDevice();
 void createLogicalDevice();
 void createSwapChain();
+void createOffscreenImages();
 void createImageViews();
 void createRenderPass();
 void createShadowMapRenderPass();
@@ -285,64 +388,90 @@ void createShadowMapGraphicsPipeline();
 void createFramebuffers();
 void createCommandPool();
 void createColorResources();
+void createSceneResources();
 void createShadowMapResources();
 void createShadowMapSampler();
 void createFramebufferForShadowMap();
 void createDepthResources();
-void createTextureImage();
-void createTextureImageView();
+void printAttachmentMemoryReport();
+void createTextures();
 void createTextureSampler();
-void createVertexBuffers();
-void createIndexBuffer();
+void createModelBuffers();
+void createMaterialBuffer();
 void createShadowMapUniformBuffers();
 void createUniformBuffers();
 void createShadowMapDescriptorPool();
 void createDescriptorPool();
 void createShadowMapDescriptorSets();
 void createDescriptorSets();
+void createTextureDescriptorSet();
 void createCommandBuffers();
+void createOverdrawQueryPool();
+void createTimestampQueryPool();
 void createSyncObjects();
 void setupInput();
+void startAssetWatcher();
 void mainLoop();
+void headlessLoop();
 
 void initVulkan()
 {
 	createInstance();
-	createSurface();
+  if (!headless)
+    createSurface();
 	pickPhysicalDevice();
 	createLogicalDevice();
-	createSwapChain();
+  if (headless)
+    createOffscreenImages();
+  else
+    createSwapChain();
 	createImageViews();
-	createRenderPass();
-	createShadowMapRenderPass();
+  if (!useDynamicRendering)
+  {
+    createRenderPass();
+    createShadowMapRenderPass();
+  }
   createShadowMapDescriptorSetLayout();
 	createDescriptorSetLayout();
 	createObjectGraphicsPipeline();
 	createShadowMapGraphicsPipeline();
 	createCommandPool();
   createColorResources();
+  createSceneResources();
   createShadowMapResources();
   createShadowMapSampler();
-  createFramebufferForShadowMap();
   createDepthResources();
-	createFramebuffers();
-  createTextureImage();
-  createTextureImageView();
+  printAttachmentMemoryReport();
+  if (!useDynamicRendering)
+  {
+    createFramebufferForShadowMap();
+    createFramebuffers();
+  }
+  // meshes first, they go up while textures are still decoding
+	createModelBuffers();
+  createTextures();
   createTextureSampler();
-	createVertexBuffers();
-	createIndexBuffer();
+  createMaterialBuffer();
   createShadowMapUniformBuffers();
 	createUniformBuffers();
   createShadowMapDescriptorPool();
 	createDescriptorPool();
 	createShadowMapDescriptorSets();
 	createDescriptorSets();
+  createTextureDescriptorSet();
 	createCommandBuffers();
+  createOverdrawQueryPool();
+  createTimestampQueryPool();
 	createSyncObjects();
-  setupInput();
+  if (!headless)
+    setupInput();
+  startAssetWatcher();
   createPhysicsThread();
   
-	mainLoop();
+  if (headless)
+    headlessLoop();
+  else
+    mainLoop();
 }
 
 // createInstance
@@ -361,16 +490,26 @@ void createInstance()
 	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.pEngineName = "RQW";
 	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	appInfo.apiVersion = VK_API_VERSION_1_0;
+
+	// 1.0 loaders don't have vkEnumerateInstanceVersion and reject anything above 1.0
+	PFN_vkEnumerateInstanceVersion enumerateInstanceVersion =
+		(PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(NULL, "vkEnumerateInstanceVersion");
+	if (enumerateInstanceVersion != NULL)
+	{
+		enumerateInstanceVersion(&instanceApiVersion);
+	}
+	appInfo.apiVersion = (instanceApiVersion >= VK_API_VERSION_1_3) ? VK_API_VERSION_1_3 : VK_API_VERSION_1_0;
 
 	VkInstanceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	createInfo.pApplicationInfo = &appInfo;
 
 	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
+	const char** glfwExtensions = NULL;
 
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+  // glfw isn't initialized in headless mode and no surface extensions are needed
+  if (!headless)
+    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 	glfwExtensionCount++;
 
 	// One more extension for mac os support
@@ -473,6 +612,8 @@ void createSurface()
 // pickPhysicalDevice
 
 bool isDeviceSuitable(VkPhysicalDevice device);
+bool checkDynamicRenderingSupport(VkPhysicalDevice device);
+void checkDescriptorIndexingSupport(VkPhysicalDevice device);
 
 void pickPhysicalDevice()
 {
@@ -500,6 +641,95 @@ void pickPhysicalDevice()
 		printf("\033[31mERR:\033[0m Failed to find a suitable GPU\n");
 		exit(-1);
 	}
+
+  useDynamicRendering = checkDynamicRenderingSupport(physicalDevice);
+  if (useDynamicRendering)
+    std::cout << "Using dynamic rendering (Vulkan 1.3)\n";
+  else
+    std::cout << "Using render passes (Vulkan 1.0)\n";
+
+  checkDescriptorIndexingSupport(physicalDevice);
+  printf("Texture array: %u slots%s\n", textureArraySize, descriptorIndexing ? ", descriptor indexing" : "");
+}
+
+bool checkDynamicRenderingSupport(VkPhysicalDevice device)
+{
+  if (DYNAMIC_RENDERING == 0 || instanceApiVersion < VK_API_VERSION_1_3)
+    return false;
+
+  VkPhysicalDeviceProperties properties = {};
+  vkGetPhysicalDeviceProperties(device, &properties);
+  if (properties.apiVersion < VK_API_VERSION_1_3)
+    return false;
+
+  VkPhysicalDeviceVulkan13Features features13 = {};
+  features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+  VkPhysicalDeviceFeatures2 features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &features13;
+  vkGetPhysicalDeviceFeatures2(device, &features2);
+
+  return features13.dynamicRendering && features13.synchronization2;
+}
+
+bool hasDeviceExtension(VkPhysicalDevice device, const char* name)
+{
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, NULL, &extensionCount, NULL);
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, NULL, &extensionCount, availableExtensions.data());
+  for (const auto& extension : availableExtensions)
+  {
+    if (strcmp(extension.extensionName, name) == 0)
+      return true;
+  }
+  return false;
+}
+
+// sets descriptorIndexing and how many slots the texture array gets, one
+// sampler per stage is left for the shadow map
+void checkDescriptorIndexingSupport(VkPhysicalDevice device)
+{
+  VkPhysicalDeviceProperties properties = {};
+  vkGetPhysicalDeviceProperties(device, &properties);
+  const VkPhysicalDeviceLimits& limits = properties.limits;
+  textureArraySize = std::min({ static_cast<uint32_t>(MAX_TEXTURES),
+      limits.maxPerStageDescriptorSamplers - 1, limits.maxPerStageDescriptorSampledImages - 1,
+      limits.maxDescriptorSetSamplers - 1, limits.maxDescriptorSetSampledImages - 1 });
+
+  // the feature query needs Vulkan 1.1, the instance asks for 1.3 or 1.0
+  if (DESCRIPTOR_INDEXING == 0 || instanceApiVersion < VK_API_VERSION_1_3 || properties.apiVersion < VK_API_VERSION_1_1)
+    return;
+  bool extension = properties.apiVersion < VK_API_VERSION_1_2;
+  if (extension && !hasDeviceExtension(device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    return;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+  indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  VkPhysicalDeviceFeatures2 features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &indexingFeatures;
+  vkGetPhysicalDeviceFeatures2(device, &features2);
+  // material textures differ within a draw
+  if (!indexingFeatures.descriptorBindingPartiallyBound || !indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+      !indexingFeatures.shaderSampledImageArrayNonUniformIndexing)
+    return;
+
+  VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+  indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties2 = {};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &indexingProperties;
+  vkGetPhysicalDeviceProperties2(device, &properties2);
+
+  descriptorIndexing = true;
+  descriptorIndexingExtension = extension;
+  textureArraySize = std::min({ static_cast<uint32_t>(MAX_TEXTURES),
+      indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers - 1,
+      indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages - 1,
+      indexingProperties.maxDescriptorSetUpdateAfterBindSamplers - 1,
+      indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages - 1 });
 }
 
 struct QueueFamilyIndices
@@ -517,6 +747,12 @@ bool isDeviceSuitable(VkPhysicalDevice device)
 {
 	struct QueueFamilyIndices indices = findQueueFamilies(device);
 
+  VkPhysicalDeviceFeatures supportedFeatures = {};
+  vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+
+  if (headless)
+    return indices.has_value_g && supportedFeatures.samplerAnisotropy;
+
 	bool extensionSupported = checkDeviceExtensionSupport(device);
 
 	bool swapChainAdequate = false;
@@ -526,9 +762,6 @@ bool isDeviceSuitable(VkPhysicalDevice device)
 		swapChainAdequate = swapChainSupport.formatCount != 0 && swapChainSupport.presentModeCount != 0;
 	}
 
-  VkPhysicalDeviceFeatures supportedFeatures = {};
-  vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
-
 	return indices.has_value_g && indices.has_value_p && extensionSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
 }
 
@@ -551,6 +784,14 @@ struct QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device)
 		}
 	}
 
+  // nothing is presented, the graphics queue stands in for the present queue
+  if (headless)
+  {
+    indices.presentFamily = indices.graphicsFamily;
+    indices.has_value_p = indices.has_value_g;
+    return indices;
+  }
+
 	for (uint32_t i = 0; i < queueFamilyCount; i++)
 	{
 		VkBool32 presentSupport = false;
@@ -652,11 +893,62 @@ void createLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures = {}; // VK FEATURES!!!
   deviceFeatures.samplerAnisotropy = VK_TRUE;
   deviceFeatures.sampleRateShading = VK_TRUE;
+
+  VkPhysicalDeviceFeatures supportedFeatures = {};
+  vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+  if (measureOverdraw && !supportedFeatures.pipelineStatisticsQuery)
+  {
+    printf("\033[33mWARN:\033[0m Pipeline statistics queries not supported, overdraw measurement disabled\n");
+    measureOverdraw = false;
+  }
+  deviceFeatures.pipelineStatisticsQuery = measureOverdraw ? VK_TRUE : VK_FALSE;
+
+  VkPhysicalDeviceProperties deviceProperties = {};
+  vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+  uint32_t queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, NULL);
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+  uint32_t timestampValidBits = queueFamilies[indices.graphicsFamily].timestampValidBits;
+  gpuTimestamps = timestampValidBits > 0;
+  if (DYNAMIC_RESOLUTION == 1 && !gpuTimestamps)
+    printf("\033[33mWARN:\033[0m Timestamp queries not supported, dynamic resolution disabled\n");
+  timestampPeriod = deviceProperties.limits.timestampPeriod;
+  timestampMask = timestampValidBits >= 64 ? 0xFFFFFFFFFFFFFFFF : (1ull << timestampValidBits) - 1;
+  textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+  textureCompressionETC2 = supportedFeatures.textureCompressionETC2 == VK_TRUE;
+  deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+  deviceFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+  // the texture array is indexed with a push constant
+  deviceFeatures.shaderSampledImageArrayDynamicIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing;
 	
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = DEVICE_EXTENSION_COUNT;
-	createInfo.ppEnabledExtensionNames = deviceExtensions;
+  VkPhysicalDeviceVulkan13Features features13 = {};
+  features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  features13.dynamicRendering = VK_TRUE;
+  features13.synchronization2 = VK_TRUE;
+  if (useDynamicRendering)
+    createInfo.pNext = &features13;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+  indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+  indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+  if (descriptorIndexing)
+  {
+    indexingFeatures.pNext = const_cast<void*>(createInfo.pNext);
+    createInfo.pNext = &indexingFeatures;
+  }
+
+  std::vector<const char*> enabledExtensions;
+  if (!headless)
+    enabledExtensions.assign(deviceExtensions, deviceExtensions + DEVICE_EXTENSION_COUNT);
+  if (descriptorIndexingExtension)
+    enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 	if (enableValidationLayers)
 	{
 		createInfo.enabledLayerCount = validationLayerCount;
@@ -676,10 +968,25 @@ void createLogicalDevice()
 
 	vkGetDeviceQueue(device, indices.graphicsFamily, 0, &graphicsQueue);
 	vkGetDeviceQueue(device, indices.presentFamily, 0, &presentQueue);
+
+  if (useDynamicRendering)
+  {
+    pfnCmdBeginRendering = (PFN_vkCmdBeginRendering)vkGetDeviceProcAddr(device, "vkCmdBeginRendering");
+    pfnCmdEndRendering = (PFN_vkCmdEndRendering)vkGetDeviceProcAddr(device, "vkCmdEndRendering");
+    pfnCmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2)vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2");
+    pfnCmdWriteTimestamp2 = (PFN_vkCmdWriteTimestamp2)vkGetDeviceProcAddr(device, "vkCmdWriteTimestamp2");
+    if (pfnCmdBeginRendering == NULL || pfnCmdEndRendering == NULL || pfnCmdPipelineBarrier2 == NULL || pfnCmdWriteTimestamp2 == NULL)
+    {
+      printf("\033[31mERR:\033[0m Failed to load Vulkan 1.3 device functions\n");
+      exit(-1);
+    }
+  }
 }
 
 // createSwapChain
 
+void updateRenderExtent();
+
 void createSwapChain()
 {
 	querySwapChainSupport(physicalDevice, &swapChainSupport);
@@ -691,6 +998,15 @@ void createSwapChain()
 	swapChainImageFormat = surfaceFormat.format;
 	swapChainExtent = extent;
 
+  // scaling needs to blit into the swap chain image
+  VkFormatProperties formatProperties;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, swapChainImageFormat, &formatProperties);
+  VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  useDynamicResolution = DYNAMIC_RESOLUTION == 1 && gpuTimestamps &&
+    (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures &&
+    (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+  updateRenderExtent();
+
 	uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
 	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
 	{
@@ -706,6 +1022,8 @@ void createSwapChain()
 	createInfo.imageExtent = extent;
 	createInfo.imageArrayLayers = 1;
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  if (useDynamicResolution)
+    createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
 	struct QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 	uint32_t queueFamilyIndices[2] = {
@@ -744,6 +1062,34 @@ void createSwapChain()
 	vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages);
 }
 
+// createOffscreenImages
+
+void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage* image, VkDeviceMemory* imageMemory);
+
+// headless replacement for createSwapChain, one image per frame in flight
+void createOffscreenImages()
+{
+  // RGBA so the readback can be written out without swizzling
+  swapChainImageFormat = VK_FORMAT_R8G8B8A8_SRGB;
+  swapChainExtent = { WIDTH, HEIGHT };
+  presentLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+  // keep the resolution fixed so frame times are comparable between runs
+  useDynamicResolution = false;
+  updateRenderExtent();
+
+  swapChainImageCount = MAX_FRAMES_IN_FLIGHT;
+  swapChainImages = (VkImage*)calloc(swapChainImageCount, sizeof(VkImage));
+  offscreenImageMemories = (VkDeviceMemory*)calloc(swapChainImageCount, sizeof(VkDeviceMemory));
+  for (uint32_t i = 0; i < swapChainImageCount; i++)
+  {
+    createImage(swapChainExtent.width, swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &swapChainImages[i], &offscreenImageMemories[i]);
+  }
+
+  std::cout << "Headless: rendering " << headlessFrameCount << " frames at "
+    << swapChainExtent.width << "x" << swapChainExtent.height << "\n";
+}
+
 // createImageViews
 
 VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
@@ -772,7 +1118,7 @@ void createRenderPass()
 	colorAttachment.format = swapChainImageFormat;
 	colorAttachment.samples = msaaSamples;
 	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // only the resolve is kept
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -790,7 +1136,10 @@ void createRenderPass()
   colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  if (useDynamicResolution)
+    colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; // blitted after the pass
+  else
+    colorAttachmentResolve.finalLayout = presentLayout;
 
   VkAttachmentReference colorAttachmentResolveRef = {};
   colorAttachmentResolveRef.attachment = 2;
@@ -965,13 +1314,6 @@ void createDescriptorSetLayout()
 	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	uboLayoutBinding.pImmutableSamplers = NULL;
 
-  VkDescriptorSetLayoutBinding samplerLayoutBinding = {};
-  samplerLayoutBinding.binding = 1;
-  samplerLayoutBinding.descriptorCount = 1;
-  samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  samplerLayoutBinding.pImmutableSamplers = NULL;
-  samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
   VkDescriptorSetLayoutBinding shadowMapSamplerLayoutBinding = {};
   shadowMapSamplerLayoutBinding.binding = 2;
   shadowMapSamplerLayoutBinding.descriptorCount = 1;
@@ -979,8 +1321,8 @@ void createDescriptorSetLayout()
   shadowMapSamplerLayoutBinding.pImmutableSamplers = NULL;
   shadowMapSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-  uint32_t bindingCount = 3;
-  VkDescriptorSetLayoutBinding bindings[] = {uboLayoutBinding, samplerLayoutBinding, shadowMapSamplerLayoutBinding};
+  uint32_t bindingCount = 2;
+  VkDescriptorSetLayoutBinding bindings[] = {uboLayoutBinding, shadowMapSamplerLayoutBinding};
 
 	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -993,21 +1335,61 @@ void createDescriptorSetLayout()
 		printf("\033[31mERR:\033[0m Failed to create descriptor set layout\n");
 		exit(-1);
 	}
+
+  // set 1, the bindless texture array
+  VkDescriptorSetLayoutBinding texturesLayoutBinding = {};
+  texturesLayoutBinding.binding = 0;
+  texturesLayoutBinding.descriptorCount = textureArraySize;
+  texturesLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  texturesLayoutBinding.pImmutableSamplers = NULL;
+  texturesLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+  // and the material table
+  VkDescriptorSetLayoutBinding materialsLayoutBinding = {};
+  materialsLayoutBinding.binding = 1;
+  materialsLayoutBinding.descriptorCount = 1;
+  materialsLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  materialsLayoutBinding.pImmutableSamplers = NULL;
+  materialsLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+  VkDescriptorSetLayoutBinding textureSetBindings[] = { texturesLayoutBinding, materialsLayoutBinding };
+  VkDescriptorBindingFlags texturesBindingFlags[] = { VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT, 0 };
+  VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+  bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  bindingFlagsInfo.bindingCount = 2;
+  bindingFlagsInfo.pBindingFlags = texturesBindingFlags;
+
+  VkDescriptorSetLayoutCreateInfo texturesLayoutInfo = {};
+  texturesLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  texturesLayoutInfo.bindingCount = 2;
+  texturesLayoutInfo.pBindings = textureSetBindings;
+  if (descriptorIndexing)
+  {
+    texturesLayoutInfo.pNext = &bindingFlagsInfo;
+    texturesLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  }
+
+  result = vkCreateDescriptorSetLayout(device, &texturesLayoutInfo, NULL, &textureDescriptorSetLayout);
+  if (result != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to create texture descriptor set layout\n");
+    exit(-1);
+  }
 }
 
 // createObjectGraphicsPipeline
 
 std::vector<char> readFile(char* filePath);
 VkShaderModule createShaderModule(std::string code);
-#include "embededFiles.hxx"
 
 void createObjectGraphicsPipeline()
 {
   char vertSrc[] = "shaders/shader.vert.spv";
   char fragSrc[] = "shaders/shader.frag.spv";
 
-  std::string objectVertShaderCode = base64_decode(objectVertShaderCodeBase64, false);
-  std::string objectFragShaderCode = base64_decode(objectFragShaderCodeBase64, false);
+  std::string objectVertShaderCode = readEmbeddedFile("shaders/objectShader.vert.spv");
+  // material textures are indexed per fragment, that needs descriptor indexing
+  std::string objectFragShaderCode = readEmbeddedFile(descriptorIndexing ? "shaders/objectShaderNonUniform.frag.spv" : "shaders/objectShader.frag.spv");
 
 	VkShaderModule objectVertShaderModule = createShaderModule(objectVertShaderCode);
 	VkShaderModule objectFragShaderModule = createShaderModule(objectFragShaderCode);
@@ -1024,6 +1406,15 @@ void createObjectGraphicsPipeline()
 	fragShaderStageInfo.module = objectFragShaderModule;
 	fragShaderStageInfo.pName = "main";
 
+  // constant_id 0 sizes the texture array
+  VkSpecializationMapEntry textureArraySizeEntry = { 0, 0, sizeof(uint32_t) };
+  VkSpecializationInfo fragSpecialization = {};
+  fragSpecialization.mapEntryCount = 1;
+  fragSpecialization.pMapEntries = &textureArraySizeEntry;
+  fragSpecialization.dataSize = sizeof(textureArraySize);
+  fragSpecialization.pData = &textureArraySize;
+  fragShaderStageInfo.pSpecializationInfo = &fragSpecialization;
+
   std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {fragShaderStageInfo, vertShaderStageInfo};
 	
 	uint32_t dynamicStateCount = 2;
@@ -1117,10 +1508,15 @@ void createObjectGraphicsPipeline()
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 1;
-	pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout; 
-	pipelineLayoutInfo.pushConstantRangeCount = 0; 
-	pipelineLayoutInfo.pPushConstantRanges = NULL; 
+  VkDescriptorSetLayout objectSetLayouts[] = { descriptorSetLayout, textureDescriptorSetLayout };
+  VkPushConstantRange drawConstantsRange = {};
+  drawConstantsRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+  drawConstantsRange.offset = 0;
+  drawConstantsRange.size = sizeof(struct DrawConstants);
+	pipelineLayoutInfo.setLayoutCount = 2;
+	pipelineLayoutInfo.pSetLayouts = objectSetLayouts; 
+	pipelineLayoutInfo.pushConstantRangeCount = 1; 
+	pipelineLayoutInfo.pPushConstantRanges = &drawConstantsRange; 
 
 	VkResult result = vkCreatePipelineLayout(device, &pipelineLayoutInfo, NULL, &objectPipelineLayout);
 	if (result != VK_SUCCESS)
@@ -1150,10 +1546,19 @@ void createObjectGraphicsPipeline()
 	pipelineInfo.pDynamicState = &dynamicState;
 
 	pipelineInfo.layout = objectPipelineLayout;
-	
+
 	pipelineInfo.renderPass = renderPass;
 	pipelineInfo.subpass = 0;
 
+  VkFormat depthFormat = findDepthFormat();
+  VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};
+  pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  pipelineRenderingInfo.colorAttachmentCount = 1;
+  pipelineRenderingInfo.pColorAttachmentFormats = &swapChainImageFormat;
+  pipelineRenderingInfo.depthAttachmentFormat = depthFormat;
+  if (useDynamicRendering)
+    pipelineInfo.pNext = &pipelineRenderingInfo;
+
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineInfo.basePipelineIndex = -1;
 
@@ -1164,6 +1569,33 @@ void createObjectGraphicsPipeline()
 		exit(-1);
 	}
 
+  // depth pre-pass: same vertex shader as the color pass so the depths match
+  // exactly for the EQUAL test, no fragment shader and no color writes
+  pipelineInfo.stageCount = 1;
+  pipelineInfo.pStages = &vertShaderStageInfo;
+  colorBlendAttachment.colorWriteMask = 0;
+
+	VkResult result3 = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &depthPrePassGraphicsPipeline);
+	if (result3 != VK_SUCCESS)
+	{
+		printf("\033[31mERR:\033[0m Failed to create depth pre-pass pipeline\n");
+		exit(-1);
+	}
+
+  // color pass after the pre-pass, depth is already final
+  pipelineInfo.stageCount = shaderStages.size();
+  pipelineInfo.pStages = shaderStages.data();
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  depthStencil.depthWriteEnable = VK_FALSE;
+  depthStencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+	VkResult result4 = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &objectEqualGraphicsPipeline);
+	if (result4 != VK_SUCCESS)
+	{
+		printf("\033[31mERR:\033[0m Failed to create depth equal graphics pipeline\n");
+		exit(-1);
+	}
+
 	vkDestroyShaderModule(device, objectVertShaderModule, nullptr);
 	vkDestroyShaderModule(device, objectFragShaderModule, nullptr);
 }
@@ -1175,8 +1607,8 @@ VkShaderModule createShaderModule(std::string code);
 
 void createShadowMapGraphicsPipeline()
 {
-  std::string shadowMapVertShaderCode = base64_decode(shadowMapVertShaderCodeBase64, false);
-  std::string shadowMapFragShaderCode = base64_decode(shadowMapFragShaderCodeBase64, false);
+  std::string shadowMapVertShaderCode = readEmbeddedFile("shaders/shadowMapShader.vert.spv");
+  std::string shadowMapFragShaderCode = readEmbeddedFile("shaders/shadowMapShader.frag.spv");
 
 	VkShaderModule shadowMapVertShaderModule = createShaderModule(shadowMapVertShaderCode);
 	VkShaderModule shadowMapFragShaderModule = createShaderModule(shadowMapFragShaderCode);
@@ -1277,7 +1709,7 @@ void createShadowMapGraphicsPipeline()
 	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	colorBlending.logicOpEnable = VK_FALSE;
 	colorBlending.logicOp = VK_LOGIC_OP_COPY;
-	colorBlending.attachmentCount = 1;
+	colorBlending.attachmentCount = 0; // depth only
 	colorBlending.pAttachments = &colorBlendAttachment;
 	colorBlending.blendConstants[0] = 0.0f;
 	colorBlending.blendConstants[1] = 0.0f;
@@ -1319,10 +1751,18 @@ void createShadowMapGraphicsPipeline()
 	pipelineInfo.pDynamicState = &dynamicState;
 
 	pipelineInfo.layout = shadowMapPipelineLayout;
-	
+
 	pipelineInfo.renderPass = shadowMapRenderPass;
 	pipelineInfo.subpass = 0;
 
+  VkFormat depthFormat = findDepthFormat();
+  VkPipelineRenderingCreateInfo pipelineRenderingInfo = {};
+  pipelineRenderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  pipelineRenderingInfo.colorAttachmentCount = 0;
+  pipelineRenderingInfo.depthAttachmentFormat = depthFormat;
+  if (useDynamicRendering)
+    pipelineInfo.pNext = &pipelineRenderingInfo;
+
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineInfo.basePipelineIndex = -1;
 
@@ -1385,7 +1825,7 @@ void createFramebuffers()
     std::array<VkImageView, 3> attachments = {
       colorImageView,
       depthImageView,
-			swapChainImageViews[i]
+			useDynamicResolution ? sceneImageView : swapChainImageViews[i]
 		};
 		VkFramebufferCreateInfo framebufferInfo = {};
 		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -1433,10 +1873,22 @@ void createColorResources()
 {
   VkFormat colorFormat = swapChainImageFormat;
 
-  createImage(swapChainExtent.width, swapChainExtent.height, 1, msaaSamples, colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &colorImage, &colorImageMemory);
+  createImage(swapChainExtent.width, swapChainExtent.height, 1, msaaSamples, colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &colorImage, &colorImageMemory);
   colorImageView = createImageView(colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 }
 
+// createSceneResources
+
+void createSceneResources()
+{
+  if (!useDynamicResolution)
+    return;
+
+  // full swap chain size, so changing the render scale never reallocates
+  createImage(swapChainExtent.width, swapChainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &sceneImage, &sceneImageMemory);
+  sceneImageView = createImageView(sceneImage, swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+}
+
 // createShadowMapResources
 
 VkFormat findDepthFormat();
@@ -1515,11 +1967,103 @@ void createDepthResources()
 {
   VkFormat depthFormat = findDepthFormat();
   
-  createImage(swapChainExtent.width, swapChainExtent.height, 1, msaaSamples, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &depthImage, &depthImageMemory);
+  createImage(swapChainExtent.width, swapChainExtent.height, 1, msaaSamples, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &depthImage, &depthImageMemory);
   depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
   transitionImageLayout(depthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1);
 }
 
+// printAttachmentMemoryReport
+
+bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+void printImageMemoryUsage(const char* name, VkImage image, VkDeviceMemory imageMemory)
+{
+  VkMemoryRequirements memRequirements;
+  vkGetImageMemoryRequirements(device, image, &memRequirements);
+
+  double reserved = static_cast<double>(memRequirements.size) / (1024.0 * 1024.0);
+  if (hasMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+  {
+    VkDeviceSize committedBytes = 0;
+    vkGetDeviceMemoryCommitment(device, imageMemory, &committedBytes);
+    double committed = static_cast<double>(committedBytes) / (1024.0 * 1024.0);
+    printf("\t%s: %.2f MiB lazily allocated, %.2f MiB committed\n", name, reserved, committed);
+  }
+  else
+  {
+    printf("\t%s: %.2f MiB device local\n", name, reserved);
+  }
+}
+
+// an unbound image like the main pass attachments, only to ask its size
+VkMemoryRequirements attachmentMemoryRequirements(VkSampleCountFlagBits samples, VkFormat format, VkImageUsageFlags usage)
+{
+  VkImageCreateInfo imageInfo = {};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.extent.width = swapChainExtent.width;
+  imageInfo.extent.height = swapChainExtent.height;
+  imageInfo.extent.depth = 1;
+  imageInfo.mipLevels = 1;
+  imageInfo.arrayLayers = 1;
+  imageInfo.format = format;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  imageInfo.usage = usage;
+  imageInfo.samples = samples;
+  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  VkImage image;
+  if (vkCreateImage(device, &imageInfo, NULL, &image) != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to create image for the attachment memory report\n");
+    exit(-1);
+  }
+  VkMemoryRequirements memRequirements;
+  vkGetImageMemoryRequirements(device, image, &memRequirements);
+  vkDestroyImage(device, image, NULL);
+  return memRequirements;
+}
+
+// MSAA color and depth only live during the main pass, on GPUs with lazily
+// allocated memory most of their size never gets backed by real memory.
+// Prints what that saves at every sample count up to the one in use, then
+// what the current attachments really committed.
+void printAttachmentMemoryReport()
+{
+  VkFormat colorFormat = swapChainImageFormat;
+  VkFormat depthFormat = findDepthFormat();
+  VkSampleCountFlagBits maxSamples = getMaxUsableSampleCount();
+  VkPhysicalDeviceProperties physicalDeviceProperties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+  VkSampleCountFlags counts = physicalDeviceProperties.limits.framebufferColorSampleCounts & physicalDeviceProperties.limits.framebufferDepthSampleCounts;
+  printf("Attachment memory (%ux%u):\n", swapChainExtent.width, swapChainExtent.height);
+  for (uint32_t samples = VK_SAMPLE_COUNT_1_BIT; samples <= static_cast<uint32_t>(maxSamples); samples <<= 1)
+  {
+    if (!(counts & samples))
+      continue;
+    VkSampleCountFlagBits sampleCount = static_cast<VkSampleCountFlagBits>(samples);
+    VkMemoryRequirements colorTransient = attachmentMemoryRequirements(sampleCount, colorFormat, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+    VkMemoryRequirements colorLocal = attachmentMemoryRequirements(sampleCount, colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+    VkMemoryRequirements depthTransient = attachmentMemoryRequirements(sampleCount, depthFormat, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    VkMemoryRequirements depthLocal = attachmentMemoryRequirements(sampleCount, depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+    // without a lazily allocated type the transient images are plain device local memory too
+    bool colorLazy = hasMemoryType(colorTransient.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    bool depthLazy = hasMemoryType(depthTransient.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    double saved = static_cast<double>((colorLazy ? colorLocal.size : 0) + (depthLazy ? depthLocal.size : 0)) / (1024.0 * 1024.0);
+    printf("\tx%u: color %.2f MiB %s / %.2f MiB device local, depth %.2f MiB %s / %.2f MiB device local, up to %.2f MiB saved\n", samples,
+        static_cast<double>(colorTransient.size) / (1024.0 * 1024.0), colorLazy ? "lazy" : "transient",
+        static_cast<double>(colorLocal.size) / (1024.0 * 1024.0),
+        static_cast<double>(depthTransient.size) / (1024.0 * 1024.0), depthLazy ? "lazy" : "transient",
+        static_cast<double>(depthLocal.size) / (1024.0 * 1024.0), saved);
+  }
+
+  printf("Attachments in use (MSAA x%d):\n", static_cast<int>(msaaSamples));
+  printImageMemoryUsage("color", colorImage, colorImageMemory);
+  printImageMemoryUsage("depth", depthImage, depthImageMemory);
+}
+
 // findDepthFormat()
 
 VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
@@ -1555,53 +2099,33 @@ VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTil
 
 void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* buffer, VkDeviceMemory * bufferMemory);
 uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
 void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage* image, VkDeviceMemory* imageMemory);
 
 void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels);
 void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 
-// createTextureImage
+// createTextures
 
 void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
 
-void createTextureImage() {
-  int texWidth, texHeight, texChannels;
-  stbi_uc* pixels = stbi_load("static/textures/statue.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-  VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-  mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-
-  if (!pixels) {
-		printf("\033[31mERR:\033[0m Failed to load texture image!\n");
-		exit(-1);
-  }
-
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
-  createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
-
-  void* data;
-  vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-  memcpy(data, pixels, (size_t)imageSize);
-  vkUnmapMemory(device, stagingBufferMemory);
-
-  stbi_image_free(pixels);
-
-  createImage(texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &textureImage, &textureImageMemory);
-
-  transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
-  copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-
-  generateMipmaps(textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
-
-  vkDestroyBuffer(device, stagingBuffer, nullptr);
-  vkFreeMemory(device, stagingBufferMemory, nullptr);
+// blocks until the asset pool is done with it, prints how long that took
+void waitForAsset(const std::shared_future<void>& loaded, const std::string& name)
+{
+  if (loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    return;
+  auto waitStart = std::chrono::steady_clock::now();
+  loaded.wait();
+  std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - waitStart;
+  printf("Waited %.2f ms for %s\n", waited.count(), name.c_str());
 }
 
 VkCommandBuffer beginSingleTimeCommands();
 void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
+#include "textureStreaming.hxx"
+
 void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
 {
   VkFormatProperties formatProperties;
@@ -1727,6 +2251,12 @@ void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCo
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device, *image, &memRequirements);
 
+  // lazily allocated memory is only a preference, mostly tile based GPUs have it
+  if ((properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) && !hasMemoryType(memRequirements.memoryTypeBits, properties))
+  {
+    properties &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+  }
+
   VkMemoryAllocateInfo allocInfo = {};
   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
   allocInfo.allocationSize = memRequirements.size;
@@ -1743,11 +2273,6 @@ void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCo
 
 VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 
-void createTextureImageView()
-{
-  textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
-}
-
 VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 {
   VkImageViewCreateInfo viewInfo = {};
@@ -1805,76 +2330,149 @@ void createTextureSampler()
   }
 }
 
-// createVertexBuffers, createIndexBuffer, createUniformBuffers
+// createModelBuffers, createUniformBuffers
 
-void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+// sets indexType and returns the size of the index buffer. The cache and
+// the loader keep 32 bit indices, small meshes go up as 16 bit.
+VkDeviceSize chooseIndexType(struct Model& model)
+{
+  model.indexType = (model.vertexCount < 65536) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  size_t indexSize = (model.indexType == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+  return indexSize * model.indexCount;
+}
 
-void createVertexBuffers()
+// indices first..first+count-1 in indexType
+void packModelIndices(const struct Model& model, uint32_t first, uint32_t count, void* out)
 {
-  for (auto& model : Models)
+  if (model.indexType == VK_INDEX_TYPE_UINT16)
   {
-    VkDeviceSize bufferSize = sizeof(model.second.vertices[0]) * model.second.vertices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, model.second.vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
-
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &(model.second.vertexBuffer), &(model.second.vertexBufferMemory));
-
-    copyBuffer(stagingBuffer, model.second.vertexBuffer, bufferSize);
-
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    uint16_t* indices16 = static_cast<uint16_t*>(out);
+    for (uint32_t i = 0; i < count; i++)
+      indices16[i] = static_cast<uint16_t>(model.indexData[first + i]);
+  }
+  else
+  {
+    memcpy(out, model.indexData + first, sizeof(uint32_t) * count);
   }
 }
 
-void createIndexBuffer()
+#include "stagingRing.hxx"
+
+// Vertex and index buffers of every model, through the staging ring. Models
+// go up in the order they finish parsing, so the first ones are copied
+// while the rest are still on the asset pool, and the CPU side of a mesh
+// is freed as soon as it's packed.
+void createModelBuffers()
 {
+  createStagingRing();
+  VkDeviceSize sourceSize = 0;
+  VkDeviceSize gpuSize = 0;
+  std::vector<struct Model*> remaining;
   for (auto& model : Models)
+    remaining.push_back(&model.second);
+  while (!remaining.empty())
   {
-    VkDeviceSize bufferSize = sizeof(model.second.indices[0]) * model.second.indices.size();
+    auto next = std::find_if(remaining.begin(), remaining.end(), [](const struct Model* model) {
+      return model->loaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+    if (next == remaining.end())
+    {
+      // nothing to pack, the GPU gets what's packed so far while we wait
+      submitStagingChunk();
+      next = remaining.begin();
+    }
+    struct Model& model = **next;
+    remaining.erase(next);
+    waitForAsset(model.loaded, model.objPath);
+
+    prepareModelVertexFormat(model);
+    VkDeviceSize vertexBytes = sizeof(struct GpuVertex) * model.vertexCount;
+    VkDeviceSize indexBytes = chooseIndexType(model);
+    sourceSize += sizeof(struct Vertex) * model.vertexCount;
+    gpuSize += vertexBytes;
+
+    createBuffer(vertexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &model.vertexBuffer, &model.vertexBufferMemory);
+    createBuffer(indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &model.indexBuffer, &model.indexBufferMemory);
+
+    stageBufferUpload(model.vertexBuffer, model.vertexCount, sizeof(struct GpuVertex), [&model](uint32_t first, uint32_t count, char* out) {
+      packModelVertices(model, first, count, reinterpret_cast<struct GpuVertex*>(out));
+    });
+    stageBufferUpload(model.indexBuffer, model.indexCount, indexBytes / std::max(model.indexCount, 1u), [&model](uint32_t first, uint32_t count, char* out) {
+      packModelIndices(model, first, count, out);
+    });
+    releaseMeshData(model);
+  }
+  submitStagingChunk();
+  uint32_t submitCount = stagingRing.submitCount;
+  uint32_t waitCount = stagingRing.waitCount;
+  destroyStagingRing();
+
+  printf("Vertex memory: %.1f KB (%zu bytes per vertex, %.1f KB as float vertices)\n",
+      static_cast<double>(gpuSize) / 1024.0, sizeof(struct GpuVertex), static_cast<double>(sourceSize) / 1024.0);
+  printf("Mesh uploads: %u staging submits through a %u KB ring, waited for a chunk %u times\n",
+      submitCount, static_cast<uint32_t>(STAGING_RING_KB), waitCount);
+}
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+// createMaterialBuffer
 
-    void* data;
-    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, model.second.indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(device, stagingBufferMemory);
+// copies one materialTable entry into the buffer, the next frame draws with it
+void writeMaterial(uint32_t index)
+{
+  memcpy(static_cast<struct GpuMaterial*>(materialBufferMapped) + index, &materialTable[index], sizeof(struct GpuMaterial));
+}
 
-    createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &(model.second.indexBuffer), &(model.second.indexBufferMemory));
+// every model's materials from firstMaterial on, also after a reload changed them
+void buildMaterialTable()
+{
+  materialTable.clear();
+  for (auto& model : Models)
+  {
+    model.second.firstMaterial = static_cast<uint32_t>(materialTable.size());
+    for (const auto& material : model.second.materials)
+    {
+      struct GpuMaterial gpuMaterial = {};
+      gpuMaterial.diffuse = glm::vec4(material.diffuse, 1.0f);
+      gpuMaterial.specular = glm::vec4(material.specular, material.shininess);
+      gpuMaterial.texture = descriptorIndexing ? material.texture : NO_TEXTURE;
+      materialTable.push_back(gpuMaterial);
+    }
+  }
+}
 
-    copyBuffer(stagingBuffer, model.second.indexBuffer, bufferSize);
+// sized for the current materialTable and left mapped
+void allocateMaterialBuffer()
+{
+  materialBufferSize = sizeof(struct GpuMaterial) * materialTable.size();
+  createBuffer(materialBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &materialBuffer, &materialBufferMemory);
+  vkMapMemory(device, materialBufferMemory, 0, materialBufferSize, 0, &materialBufferMapped);
+}
 
-    vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
-  }
+void createMaterialBuffer()
+{
+  buildMaterialTable();
+  allocateMaterialBuffer();
+  for (uint32_t i = 0; i < materialTable.size(); i++)
+    writeMaterial(i);
+  printf("Materials: %zu\n", materialTable.size());
 }
 
 // createShadowMapUniformBuffers
 
 void createShadowMapUniformBuffers()
 {
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     VkDeviceSize bufferSize = sizeof(struct ShadowUBO);
     
-    gameObject.shadowMapUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    gameObject.shadowMapUniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    gameObject.shadowMapUniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.shadowMapUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.shadowMapUniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.shadowMapUniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-      createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &gameObject.shadowMapUniformBuffers[i], &gameObject.shadowMapUniformBuffersMemory[i]);
+      createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &renderable.shadowMapUniformBuffers[i], &renderable.shadowMapUniformBuffersMemory[i]);
 
-      vkMapMemory(device, gameObject.shadowMapUniformBuffersMemory[i], 0, bufferSize, 0, &gameObject.shadowMapUniformBuffersMapped[i]);
+      vkMapMemory(device, renderable.shadowMapUniformBuffersMemory[i], 0, bufferSize, 0, &renderable.shadowMapUniformBuffersMapped[i]);
     }
   }
 }
@@ -1883,19 +2481,19 @@ void createShadowMapUniformBuffers()
 
 void createUniformBuffers()
 {
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     VkDeviceSize bufferSize = sizeof(struct SceneUBO);
     
-    gameObject.uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    gameObject.uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-    gameObject.uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-      createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &gameObject.uniformBuffers[i], &gameObject.uniformBuffersMemory[i]); //attention
+      createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &renderable.uniformBuffers[i], &renderable.uniformBuffersMemory[i]); //attention
 
-      vkMapMemory(device, gameObject.uniformBuffersMemory[i], 0, bufferSize, 0, &gameObject.uniformBuffersMapped[i]);
+      vkMapMemory(device, renderable.uniformBuffersMemory[i], 0, bufferSize, 0, &renderable.uniformBuffersMapped[i]);
     }
   }
 }
@@ -1933,6 +2531,20 @@ void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyF
 	vkBindBufferMemory(device, *buffer, *bufferMemory, 0);
 }
 
+bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+	{
+		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
 	VkPhysicalDeviceMemoryProperties memProperties;
@@ -1952,6 +2564,11 @@ uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 VkCommandBuffer beginSingleTimeCommands();
 void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
+void cmdImageBarrier2(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels,
+    VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout);
+
 void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
@@ -1995,6 +2612,12 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
   VkPipelineStageFlags sourceStage;
   VkPipelineStageFlags destinationStage;
 
+  // synchronization2 masks, used when the device runs the Vulkan 1.3 path
+  VkPipelineStageFlags2 sourceStage2;
+  VkPipelineStageFlags2 destinationStage2;
+  VkAccessFlags2 sourceAccess2;
+  VkAccessFlags2 destinationAccess2;
+
   if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
   {
     barrier.srcAccessMask = 0;
@@ -2002,6 +2625,11 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
 
     sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
     destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    sourceStage2 = VK_PIPELINE_STAGE_2_NONE;
+    sourceAccess2 = VK_ACCESS_2_NONE;
+    destinationStage2 = VK_PIPELINE_STAGE_2_COPY_BIT;
+    destinationAccess2 = VK_ACCESS_2_TRANSFER_WRITE_BIT;
   }
   else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
   {
@@ -2010,6 +2638,11 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
 
     sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+    sourceStage2 = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT;
+    sourceAccess2 = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    destinationStage2 = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    destinationAccess2 = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
   }
   else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
   {
@@ -2018,6 +2651,11 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
 
     sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
     destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+
+    sourceStage2 = VK_PIPELINE_STAGE_2_NONE;
+    sourceAccess2 = VK_ACCESS_2_NONE;
+    destinationStage2 = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+    destinationAccess2 = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
   }
   else 
   {
@@ -2025,18 +2663,70 @@ void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayo
     exit(-1);
   }
 
-  vkCmdPipelineBarrier(
-      commandBuffer,
-      sourceStage, destinationStage,
-      0,
-      0, NULL,
-      0, NULL,
-      1, &barrier
-      );
+  if (useDynamicRendering)
+  {
+    cmdImageBarrier2(commandBuffer, image, barrier.subresourceRange.aspectMask, mipLevels,
+        sourceStage2, sourceAccess2, destinationStage2, destinationAccess2,
+        oldLayout, newLayout);
+  }
+  else
+  {
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        sourceStage, destinationStage,
+        0,
+        0, NULL,
+        0, NULL,
+        1, &barrier
+        );
+  }
 
   endSingleTimeCommands(commandBuffer);
 }
 
+VkImageMemoryBarrier2 imageBarrier2(VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels,
+    VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+  VkImageMemoryBarrier2 barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+  barrier.srcStageMask = srcStageMask;
+  barrier.srcAccessMask = srcAccessMask;
+  barrier.dstStageMask = dstStageMask;
+  barrier.dstAccessMask = dstAccessMask;
+  barrier.oldLayout = oldLayout;
+  barrier.newLayout = newLayout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = aspectMask;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = mipLevels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+  return barrier;
+}
+
+void cmdImageBarriers2(VkCommandBuffer commandBuffer, uint32_t barrierCount, const VkImageMemoryBarrier2* barriers)
+{
+  VkDependencyInfo dependencyInfo = {};
+  dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+  dependencyInfo.imageMemoryBarrierCount = barrierCount;
+  dependencyInfo.pImageMemoryBarriers = barriers;
+  pfnCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void cmdImageBarrier2(VkCommandBuffer commandBuffer, VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels,
+    VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+  VkImageMemoryBarrier2 barrier = imageBarrier2(image, aspectMask, mipLevels,
+      srcStageMask, srcAccessMask, dstStageMask, dstAccessMask, oldLayout, newLayout);
+  cmdImageBarriers2(commandBuffer, 1, &barrier);
+}
+
 void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
 {
   VkCommandBuffer commandBuffer = beginSingleTimeCommands();
@@ -2111,13 +2801,13 @@ void createShadowMapDescriptorPool()
 {
   std::vector<VkDescriptorPoolSize> poolSizes(1);
   poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-  poolSizes[0].descriptorCount = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
+  poolSizes[0].descriptorCount = renderables.components.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
 
 	VkDescriptorPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	poolInfo.poolSizeCount = poolSizes.size();
 	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
+	poolInfo.maxSets = renderables.components.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
 
 	VkResult result = vkCreateDescriptorPool(device, &poolInfo, NULL, &shadowMapDescriptorPool);
 	if (result != VK_SUCCESS)
@@ -2125,26 +2815,46 @@ void createShadowMapDescriptorPool()
 		printf("\033[31mERR:\033[0m Failed to create descriptor pool\n");
 		exit(-1);
 	}
+
+  // one set for the texture array and material table, shared by every object and frame
+  std::array<VkDescriptorPoolSize, 2> texturePoolSizes = {};
+  texturePoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  texturePoolSizes[0].descriptorCount = textureArraySize;
+  texturePoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  texturePoolSizes[1].descriptorCount = 1;
+
+  VkDescriptorPoolCreateInfo texturePoolInfo = {};
+  texturePoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  texturePoolInfo.poolSizeCount = texturePoolSizes.size();
+  texturePoolInfo.pPoolSizes = texturePoolSizes.data();
+  texturePoolInfo.maxSets = 1;
+  if (descriptorIndexing)
+    texturePoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+
+  result = vkCreateDescriptorPool(device, &texturePoolInfo, NULL, &textureDescriptorPool);
+  if (result != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to create texture descriptor pool\n");
+    exit(-1);
+  }
 }
 
 // createDescriptorPool
 
 void createDescriptorPool()
 {
-  std::vector<VkDescriptorPoolSize> poolSizes(3);
+  std::vector<VkDescriptorPoolSize> poolSizes(2);
   poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-  poolSizes[0].descriptorCount = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
+  poolSizes[0].descriptorCount = renderables.components.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
   poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  poolSizes[1].descriptorCount = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
-  poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  poolSizes[2].descriptorCount = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
+  poolSizes[1].descriptorCount = renderables.components.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
 
 
 	VkDescriptorPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	poolInfo.poolSizeCount = poolSizes.size();
 	poolInfo.pPoolSizes = poolSizes.data();
-	poolInfo.maxSets = gameObjects.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
+	poolInfo.maxSets = renderables.components.size() * (uint32_t)MAX_FRAMES_IN_FLIGHT;
 
 	VkResult result = vkCreateDescriptorPool(device, &poolInfo, NULL, &descriptorPool);
 	if (result != VK_SUCCESS)
@@ -2158,7 +2868,7 @@ void createDescriptorPool()
 
 void createShadowMapDescriptorSets()
 {
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, shadowMapDescriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo = {};
@@ -2167,10 +2877,10 @@ void createShadowMapDescriptorSets()
     allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
     allocInfo.pSetLayouts = layouts.data();
 
-    gameObject.shadowMapDescriptorSets.clear();
-    gameObject.shadowMapDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.shadowMapDescriptorSets.clear();
+    renderable.shadowMapDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 
-    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, gameObject.shadowMapDescriptorSets.data());
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, renderable.shadowMapDescriptorSets.data());
     if (result != VK_SUCCESS)
     {
       printf("\033[31mERR:\033[0m Failed to allocate descriptor sets for shadow map\n");
@@ -2180,7 +2890,7 @@ void createShadowMapDescriptorSets()
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
       VkDescriptorBufferInfo bufferInfo = {};
-      bufferInfo.buffer = gameObject.shadowMapUniformBuffers[i];
+      bufferInfo.buffer = renderable.shadowMapUniformBuffers[i];
       bufferInfo.offset = 0;
       bufferInfo.range = sizeof(struct ShadowUBO);
 
@@ -2188,7 +2898,7 @@ void createShadowMapDescriptorSets()
       std::vector<VkWriteDescriptorSet> descriptorWrites(descriptorWriteCount);
 
       descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[0].dstSet = gameObject.shadowMapDescriptorSets[i];
+      descriptorWrites[0].dstSet = renderable.shadowMapDescriptorSets[i];
       descriptorWrites[0].dstBinding = 0;
       descriptorWrites[0].dstArrayElement = 0;
       descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -2204,7 +2914,7 @@ void createShadowMapDescriptorSets()
 
 void createDescriptorSets()
 {
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo = {};
@@ -2213,10 +2923,10 @@ void createDescriptorSets()
     allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
     allocInfo.pSetLayouts = layouts.data();
 
-    gameObject.descriptorSets.clear();
-    gameObject.descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    renderable.descriptorSets.clear();
+    renderable.descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 
-    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, gameObject.descriptorSets.data());
+    VkResult result = vkAllocateDescriptorSets(device, &allocInfo, renderable.descriptorSets.data());
     if (result != VK_SUCCESS)
     {
       printf("\033[31mERR:\033[0m Failed to allocate descriptor sets\n");
@@ -2226,25 +2936,20 @@ void createDescriptorSets()
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
       VkDescriptorBufferInfo bufferInfo = {};
-      bufferInfo.buffer = gameObject.uniformBuffers[i];
+      bufferInfo.buffer = renderable.uniformBuffers[i];
       bufferInfo.offset = 0;
       bufferInfo.range = sizeof(struct SceneUBO);
 
-      VkDescriptorImageInfo imageInfo = {};
-      imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-      imageInfo.imageView = textureImageView;
-      imageInfo.sampler = textureSampler;
-
       VkDescriptorImageInfo shadowMapInfo{};
       shadowMapInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
       shadowMapInfo.imageView = shadowMapImageView;
       shadowMapInfo.sampler = shadowMapSampler;
 
-      uint32_t descriptorWriteCount = 3;
+      uint32_t descriptorWriteCount = 2;
       std::vector<VkWriteDescriptorSet> descriptorWrites(descriptorWriteCount);
 
       descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[0].dstSet = gameObject.descriptorSets[i];
+      descriptorWrites[0].dstSet = renderable.descriptorSets[i];
       descriptorWrites[0].dstBinding = 0;
       descriptorWrites[0].dstArrayElement = 0;
       descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -2252,26 +2957,94 @@ void createDescriptorSets()
       descriptorWrites[0].pBufferInfo = &bufferInfo;
 
       descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[1].dstSet = gameObject.descriptorSets[i];
-      descriptorWrites[1].dstBinding = 1;
+      descriptorWrites[1].dstSet = renderable.descriptorSets[i];
+      descriptorWrites[1].dstBinding = 2;
       descriptorWrites[1].dstArrayElement = 0;
       descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
       descriptorWrites[1].descriptorCount = 1;
-      descriptorWrites[1].pImageInfo = &imageInfo;
-
-      descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      descriptorWrites[2].dstSet = gameObject.descriptorSets[i];
-      descriptorWrites[2].dstBinding = 2;
-      descriptorWrites[2].dstArrayElement = 0;
-      descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      descriptorWrites[2].descriptorCount = 1;
-      descriptorWrites[2].pImageInfo = &shadowMapInfo;
+      descriptorWrites[1].pImageInfo = &shadowMapInfo;
 
       vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
     }
   }
 }
 
+void writeMaterialDescriptor();
+
+// slot of the texture array, after its image changed. Without descriptor
+// indexing every slot has to be valid, the ones past the last texture
+// repeat the textures.
+void writeTextureDescriptors(uint32_t texture)
+{
+  if (textureDescriptorSet == VK_NULL_HANDLE)
+    return; // createTextureDescriptorSet writes all of them
+  VkDescriptorImageInfo imageInfo = {};
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  imageInfo.imageView = textures[texture].view;
+  imageInfo.sampler = textureSampler;
+
+  std::vector<VkWriteDescriptorSet> descriptorWrites;
+  for (uint32_t slot = texture; slot < textureArraySize; slot += textures.size())
+  {
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = textureDescriptorSet;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = slot;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+    descriptorWrites.push_back(descriptorWrite);
+    if (descriptorIndexing)
+      break;
+  }
+  vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void createTextureDescriptorSet()
+{
+  if (textures.size() > textureArraySize)
+  {
+    printf("\033[31mERR:\033[0m %zu textures don't fit the texture array of %u\n", textures.size(), textureArraySize);
+    exit(-1);
+  }
+
+  VkDescriptorSetAllocateInfo allocInfo = {};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = textureDescriptorPool;
+  allocInfo.descriptorSetCount = 1;
+  allocInfo.pSetLayouts = &textureDescriptorSetLayout;
+  VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &textureDescriptorSet);
+  if (result != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to allocate texture descriptor set\n");
+    exit(-1);
+  }
+
+  for (uint32_t i = 0; i < textures.size(); i++)
+    writeTextureDescriptors(i);
+  writeMaterialDescriptor();
+}
+
+// binding 1, again when the material buffer was replaced
+void writeMaterialDescriptor()
+{
+  VkDescriptorBufferInfo materialsInfo = {};
+  materialsInfo.buffer = materialBuffer;
+  materialsInfo.offset = 0;
+  materialsInfo.range = VK_WHOLE_SIZE;
+
+  VkWriteDescriptorSet descriptorWrite = {};
+  descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptorWrite.dstSet = textureDescriptorSet;
+  descriptorWrite.dstBinding = 1;
+  descriptorWrite.dstArrayElement = 0;
+  descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  descriptorWrite.descriptorCount = 1;
+  descriptorWrite.pBufferInfo = &materialsInfo;
+  vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+}
+
 // createCommandBuffers
 
 void createCommandBuffers()
@@ -2290,6 +3063,83 @@ void createCommandBuffers()
 	}
 }
 
+// createOverdrawQueryPool
+
+void createOverdrawQueryPool()
+{
+  if (!measureOverdraw)
+    return;
+
+  VkQueryPoolCreateInfo queryPoolInfo = {};
+  queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+  queryPoolInfo.queryCount = MAX_FRAMES_IN_FLIGHT;
+  queryPoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+  VkResult result = vkCreateQueryPool(device, &queryPoolInfo, NULL, &overdrawQueryPool);
+  if (result != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to create overdraw query pool\n");
+    exit(-1);
+  }
+}
+
+void createTimestampQueryPool()
+{
+  if (DYNAMIC_RESOLUTION != 1 || !gpuTimestamps)
+    return;
+
+  VkQueryPoolCreateInfo queryPoolInfo = {};
+  queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  queryPoolInfo.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+
+  VkResult result = vkCreateQueryPool(device, &queryPoolInfo, NULL, &timestampQueryPool);
+  if (result != VK_SUCCESS)
+  {
+    printf("\033[31mERR:\033[0m Failed to create timestamp query pool\n");
+    exit(-1);
+  }
+}
+
+// the legacy stage bits have the same values as their synchronization2 ones
+void cmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 stage, uint32_t query)
+{
+  if (useDynamicRendering)
+    pfnCmdWriteTimestamp2(commandBuffer, stage, timestampQueryPool, query);
+  else
+    vkCmdWriteTimestamp(commandBuffer, static_cast<VkPipelineStageFlagBits>(stage), timestampQueryPool, query);
+}
+
+uint64_t overdrawInvocations = 0;
+uint64_t overdrawPixels = 0;
+auto overdrawReportTime = std::chrono::steady_clock::now();
+
+// called after the frame's queue wait, so the result is always available
+void readOverdrawQuery()
+{
+  if (!measureOverdraw)
+    return;
+
+  uint64_t invocations = 0;
+  VkResult result = vkGetQueryPoolResults(device, overdrawQueryPool, currentFrame, 1, sizeof(invocations), &invocations, sizeof(invocations), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+  if (result != VK_SUCCESS)
+    return;
+
+  overdrawInvocations += invocations;
+  overdrawPixels += static_cast<uint64_t>(renderExtent.width) * renderExtent.height;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - overdrawReportTime >= std::chrono::seconds(1))
+  {
+    double shadedPerPixel = static_cast<double>(overdrawInvocations) / static_cast<double>(std::max<uint64_t>(overdrawPixels, 1));
+    printf("overdraw: %.2f fragment shader invocations per pixel (depth pre-pass %s)\n", shadedPerPixel, depthPrePass ? "on" : "off");
+    overdrawInvocations = 0;
+    overdrawPixels = 0;
+    overdrawReportTime = now;
+  }
+}
+
 // createSyncObjects
 
 void createSyncObjects()
@@ -2316,6 +3166,9 @@ void createSyncObjects()
 	}
 }
 
+// what this frame draws, interpolated from the latest physics snapshot
+std::vector<struct ObjectTransform> renderTransforms;
+
 // updateShadowUniformBuffer
 
 void updateShadowUniformBuffer(uint32_t currentImage)
@@ -2339,13 +3192,49 @@ void updateShadowUniformBuffer(uint32_t currentImage)
 
   sharedLightProjViewMatrix = proj * view;
 
-  for (auto& gameObject : gameObjects)
+  for (size_t i = 0; i < renderables.components.size(); i++)
   {
-    glm::mat4 model = gameObject.getModelMatrix();
+    struct Renderable& renderable = renderables.components[i];
+    glm::mat4 model = transformMatrix(renderTransforms[renderables.entities[i]]) * renderable.model->positionMatrix;
     ubo.lightSpaceMatrix = sharedLightProjViewMatrix * model;
 
-    memcpy(gameObject.shadowMapUniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+    memcpy(renderable.shadowMapUniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+  }
+}
+
+// how many pixels one unit of the model covers at the point of its bounds
+// nearest the camera, infinite with the camera inside them
+float projectedPixelsPerUnit(const struct Model& model, const glm::mat4& objectMatrix, const glm::mat4& view, const glm::mat4& proj)
+{
+  glm::vec3 worldMin = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 worldMax = glm::vec3(std::numeric_limits<float>::lowest());
+  for (int corner = 0; corner < 8; corner++)
+  {
+    glm::vec3 local = glm::vec3(
+        (corner & 1) ? model.boundsMax.x : model.boundsMin.x,
+        (corner & 2) ? model.boundsMax.y : model.boundsMin.y,
+        (corner & 4) ? model.boundsMax.z : model.boundsMin.z);
+    glm::vec3 world = glm::vec3(objectMatrix * glm::vec4(local, 1.0f));
+    worldMin = glm::min(worldMin, world);
+    worldMax = glm::max(worldMax, world);
   }
+  glm::vec3 camPos = glm::vec3(glm::inverse(view)[3]);
+  float distance = glm::length(glm::clamp(camPos, worldMin, worldMax) - camPos);
+  if (distance <= 0.0f)
+    return std::numeric_limits<float>::infinity();
+
+  float scale = std::max({ glm::length(glm::vec3(objectMatrix[0])), glm::length(glm::vec3(objectMatrix[1])), glm::length(glm::vec3(objectMatrix[2])) });
+  return scale / distance * std::abs(proj[1][1]) * 0.5f * static_cast<float>(renderExtent.height);
+}
+
+// picks the coarsest detail level whose error stays under LOD_ERROR_PIXELS
+// on screen
+uint32_t selectLod(const struct Model& model, float pixelsPerUnit)
+{
+  uint32_t lod = 0;
+  while (lod + 1 < model.lods.size() && model.lods[lod + 1].error * pixelsPerUnit <= LOD_ERROR_PIXELS)
+    lod++;
+  return lod;
 }
 
 // updateSceneUniformBuffer
@@ -2374,15 +3263,29 @@ void updateSceneUniformBuffer(uint32_t currentImage)
   ubo.shadowMapResolution = glm::vec3(static_cast<float>(SHADOW_MAP_RESOLUTION));
   ubo.biasFactor = glm::vec3(biasFactor);
 
-  for (auto& gameObject : gameObjects)
+  for (size_t i = 0; i < renderables.components.size(); i++)
   {
-    ubo.model = gameObject.getModelMatrix();
-    ubo.normalMatrix = glm::transpose(glm::inverse(ubo.model));
-    ubo.normalViewMatrix = glm::transpose(glm::inverse(ubo.view * ubo.model));
+    struct Renderable& renderable = renderables.components[i];
+    const struct Model& model = *renderable.model;
+    glm::mat4 objectMatrix = transformMatrix(renderTransforms[renderables.entities[i]]);
+    // positions may be quantized, normals aren't
+    ubo.model = objectMatrix * model.positionMatrix;
+    ubo.normalMatrix = glm::transpose(glm::inverse(objectMatrix));
+    ubo.normalViewMatrix = glm::transpose(glm::inverse(ubo.view * objectMatrix));
     ubo.lightSpaceMatrix = sharedLightProjViewMatrix * ubo.model;
-    ubo.materialSpecular = glm::vec3(0.3f);
-
-    memcpy(gameObject.uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+    float pixelsPerUnit = projectedPixelsPerUnit(model, objectMatrix, ubo.view, ubo.proj);
+    // the shadow pass draws the same level, it's recorded after this
+    renderable.lod = selectLod(model, pixelsPerUnit);
+    // as if the texture was stretched over the largest side of the bounds once
+    glm::vec3 extent = model.boundsMax - model.boundsMin;
+    float projectedPixels = pixelsPerUnit * std::max({ extent.x, extent.y, extent.z });
+    requestTextureLevel(renderable.texture, projectedPixels);
+    // the map_Kd ones are only drawn with descriptor indexing
+    if (descriptorIndexing)
+      for (const auto& material : model.materials)
+        requestTextureLevel(material.texture, projectedPixels);
+
+    memcpy(renderable.uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
   }
 }
 
@@ -2438,6 +3341,68 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
         key == GLFW_KEY_SPACE
       ) && action == GLFW_PRESS)
 		jump();
+  if (key == GLFW_KEY_P && action == GLFW_PRESS)
+  {
+    depthPrePass = !depthPrePass;
+    std::cout << "Depth pre-pass " << (depthPrePass ? "on" : "off") << "\n";
+  }
+}
+
+// updateRenderScale
+
+double smoothedRenderTime = 0.0;
+
+void updateRenderExtent()
+{
+  if (!useDynamicResolution)
+  {
+    renderExtent = swapChainExtent;
+    return;
+  }
+
+  renderExtent.width = std::max(1u, static_cast<uint32_t>(static_cast<float>(swapChainExtent.width) * renderScale));
+  renderExtent.height = std::max(1u, static_cast<uint32_t>(static_cast<float>(swapChainExtent.height) * renderScale));
+}
+
+// seconds between the frame's two timestamps, called after the frame's queue
+// wait like readOverdrawQuery
+double readRenderTime()
+{
+  uint64_t timestamps[2] = {};
+  VkResult result = vkGetQueryPoolResults(device, timestampQueryPool, currentFrame * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+  if (result != VK_SUCCESS)
+    return smoothedRenderTime;
+
+  uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+  return static_cast<double>(ticks) * static_cast<double>(timestampPeriod) * 1e-9;
+}
+
+// renderTime is the GPU time of the shadow and main pass. The blit to the
+// swap chain image is outside of it and is the only part that waits for the
+// image to be acquired, so waiting for the present engine under VSYNC doesn't
+// count.
+void updateRenderScale(double renderTime)
+{
+  if (!useDynamicResolution)
+    return;
+
+  if (smoothedRenderTime == 0.0)
+    smoothedRenderTime = renderTime;
+  smoothedRenderTime = smoothedRenderTime * 0.9 + renderTime * 0.1;
+
+  const double targetRenderTime = 1.0 / static_cast<double>(TARGET_FPS);
+  double headroom = targetRenderTime / smoothedRenderTime;
+
+  // shrink as soon as we're over budget, only grow back with clear headroom,
+  // otherwise the scale keeps bouncing around the target
+  if (headroom < 1.0 || headroom > 1.3)
+  {
+    // fragment cost goes with the area, so correct the side length by sqrt
+    float correction = static_cast<float>(std::sqrt(headroom));
+    renderScale *= 1.0f + (correction - 1.0f) * 0.1f;
+    renderScale = std::clamp(renderScale, MIN_RENDER_SCALE, 1.0f);
+    updateRenderExtent();
+  }
 }
 
 // mainLoop
@@ -2477,27 +3442,147 @@ void mainLoop()
 	vkDeviceWaitIdle(device);
 }
 
+void writeFrameToFile(VkImage image, const char* filePath);
+
+// same frame loop without window events or the MAX_FPS cap, renders a fixed
+// number of frames and prints frame time stats for benchmarking
+void headlessLoop()
+{
+  std::vector<double> frameTimes;
+  frameTimes.reserve(headlessFrameCount);
+
+  auto startTime = std::chrono::steady_clock::now();
+  auto previousTime = startTime;
+
+  for (uint32_t i = 0; i < headlessFrameCount; i++)
+  {
+    drawFrame();
+
+    auto currentTime = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = currentTime - previousTime;
+    deltaTime = elapsed.count();
+    fps = 1.0 / deltaTime;
+    frameTimes.push_back(deltaTime);
+    previousTime = currentTime;
+  }
+	vkDeviceWaitIdle(device);
+
+  std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+  std::sort(frameTimes.begin(), frameTimes.end());
+  if (!frameTimes.empty())
+  {
+    printf("Headless: %zu frames in %.3f s, avg %.3f ms, min %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms (%.1f fps)\n",
+        frameTimes.size(), totalTime.count(),
+        totalTime.count() * 1000.0 / static_cast<double>(frameTimes.size()),
+        frameTimes.front() * 1000.0,
+        frameTimes[frameTimes.size() / 2] * 1000.0,
+        frameTimes[(frameTimes.size() * 99) / 100] * 1000.0,
+        frameTimes.back() * 1000.0,
+        static_cast<double>(frameTimes.size()) / totalTime.count());
+  }
+
+  if (HEADLESS_READBACK == 1 && headlessFrameCount > 0)
+  {
+    // currentFrame already moved past the last submitted frame
+    uint32_t lastImage = (currentFrame + MAX_FRAMES_IN_FLIGHT - 1) % MAX_FRAMES_IN_FLIGHT;
+    writeFrameToFile(swapChainImages[lastImage], "headless.ppm");
+  }
+}
+
+void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer* buffer, VkDeviceMemory * bufferMemory);
+VkCommandBuffer beginSingleTimeCommands();
+void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+
+// copies an offscreen image (in TRANSFER_SRC_OPTIMAL) back and writes it as a binary ppm
+void writeFrameToFile(VkImage image, const char* filePath)
+{
+  uint32_t width = swapChainExtent.width;
+  uint32_t height = swapChainExtent.height;
+  VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * 4;
+
+  VkBuffer readbackBuffer;
+  VkDeviceMemory readbackBufferMemory;
+  createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &readbackBuffer, &readbackBufferMemory);
+
+  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+
+  VkBufferImageCopy region = {};
+  region.bufferOffset = 0;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageOffset = {0, 0, 0};
+  region.imageExtent = { width, height, 1 };
+  vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer, 1, &region);
+
+  endSingleTimeCommands(commandBuffer);
+
+  void* data;
+  vkMapMemory(device, readbackBufferMemory, 0, imageSize, 0, &data);
+  const unsigned char* pixels = static_cast<const unsigned char*>(data);
+
+  FILE* file = fopen(filePath, "wb");
+  if (file == NULL)
+  {
+    printf("\033[31mERR:\033[0m Failed to open %s for writing\n", filePath);
+    exit(-1);
+  }
+  fprintf(file, "P6\n%u %u\n255\n", width, height);
+  std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width; x++)
+    {
+      const unsigned char* pixel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+      row[x * 3 + 0] = pixel[0];
+      row[x * 3 + 1] = pixel[1];
+      row[x * 3 + 2] = pixel[2];
+    }
+    fwrite(row.data(), 1, row.size(), file);
+  }
+  fclose(file);
+
+  vkUnmapMemory(device, readbackBufferMemory);
+  vkDestroyBuffer(device, readbackBuffer, NULL);
+  vkFreeMemory(device, readbackBufferMemory, NULL);
+
+  std::cout << "Headless: wrote last frame to " << filePath << "\n";
+}
+
 void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 void recreateSwapChain();
+double readRenderTime();
+void updateRenderScale(double renderTime);
+void readOverdrawQuery();
+
+#include "hotReload.hxx"
 
 void drawFrame()
 {
 	vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+  updateHotReload();
+  updateTextureStreaming();
 
-	uint32_t imageIndex;
+	uint32_t imageIndex = currentFrame;
 
-	VkResult result1 = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+  if (!headless)
+  {
+    VkResult result1 = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
-	if (result1 == VK_ERROR_OUT_OF_DATE_KHR)
-	{
-		recreateSwapChain();
-		return;
-	}
-	else if (result1 != VK_SUCCESS && result1 != VK_SUBOPTIMAL_KHR)
-	{
-		printf("\033[31mERR:\033[0m Failed to acquire swap chain image\n");
-		exit(-1);
-	}
+    if (result1 == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+      recreateSwapChain();
+      return;
+    }
+    else if (result1 != VK_SUCCESS && result1 != VK_SUBOPTIMAL_KHR)
+    {
+      printf("\033[31mERR:\033[0m Failed to acquire swap chain image\n");
+      exit(-1);
+    }
+  }
 
 
 	vkResetFences(device, 1, &inFlightFences[currentFrame]);
@@ -2509,9 +3594,12 @@ void drawFrame()
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
 	VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-	VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+	// when scaling only the blit touches the swap chain image, the passes
+	// before it don't have to wait for it to be acquired
+	VkPipelineStageFlags waitStages[] = {useDynamicResolution ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
 
-	submitInfo.waitSemaphoreCount = 1;
+	// offscreen images are never acquired or presented, so no semaphores
+	submitInfo.waitSemaphoreCount = headless ? 0 : 1;
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
 
@@ -2519,7 +3607,7 @@ void drawFrame()
 	submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
 
 	VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = headless ? 0 : 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
 	VkResult result2 = vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]);
@@ -2530,6 +3618,17 @@ void drawFrame()
 	}
   vkQueueWaitIdle(graphicsQueue);
 
+  if (useDynamicResolution)
+    updateRenderScale(readRenderTime());
+  readOverdrawQuery();
+
+  if (headless)
+  {
+    reportFirstFrame();
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    return;
+  }
+
 	VkPresentInfoKHR presentInfo = {};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.waitSemaphoreCount = 1;
@@ -2542,6 +3641,7 @@ void drawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 
 	VkResult result3 = vkQueuePresentKHR(presentQueue, &presentInfo);
+  reportFirstFrame();
 
 	if (result3 == VK_ERROR_OUT_OF_DATE_KHR || result3 == VK_SUBOPTIMAL_KHR || framebufferResized)
 	{
@@ -2562,6 +3662,14 @@ void drawFrame()
 void recordShadowMapCommands(VkCommandBuffer commandBuffer);
 void transitionShadowMapToRead(VkCommandBuffer commandBuffer);
 void recordMainRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+void beginMainRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const VkClearValue* clearValues);
+void blitSceneToSwapChain(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+void recordObjectDraws(VkCommandBuffer commandBuffer, VkPipeline pipeline);
+VkImageMemoryBarrier2 imageBarrier2(VkImage image, VkImageAspectFlags aspectMask, uint32_t mipLevels,
+    VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+    VkImageLayout oldLayout, VkImageLayout newLayout);
+void cmdImageBarriers2(VkCommandBuffer commandBuffer, uint32_t barrierCount, const VkImageMemoryBarrier2* barriers);
 
 void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
@@ -2578,9 +3686,18 @@ void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 		exit(-1);
 	}
   
+  // both passes draw the same state
+  interpolateSnapshot(acquireSnapshot(), renderTransforms);
 	updateShadowUniformBuffer(currentFrame);
 	updateSceneUniformBuffer(currentFrame);
+  if (useDynamicResolution)
+  {
+    vkCmdResetQueryPool(commandBuffer, timestampQueryPool, currentFrame * 2, 2);
+    cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, currentFrame * 2);
+  }
   recordShadowMapCommands(commandBuffer);
+  if (measureOverdraw)
+    vkCmdResetQueryPool(commandBuffer, overdrawQueryPool, currentFrame, 1);
   recordMainRenderCommands(commandBuffer, imageIndex);
 
 	VkResult result4 = vkEndCommandBuffer(commandBuffer);
@@ -2608,7 +3725,37 @@ void recordShadowMapCommands(VkCommandBuffer commandBuffer)
 	shadowMapRenderPassInfo.clearValueCount = 1;
 	shadowMapRenderPassInfo.pClearValues = shadowMapClearColor;
 
-	vkCmdBeginRenderPass(commandBuffer, &shadowMapRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  if (useDynamicRendering)
+  {
+    // previous frame sampled the shadow map, contents are cleared anyway
+    cmdImageBarrier2(commandBuffer, shadowMapImage, VK_IMAGE_ASPECT_DEPTH_BIT, 1,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+    VkRenderingAttachmentInfo depthAttachment = {};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = shadowMapImageView;
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.clearValue = shadowMapClearColor[0];
+
+    VkRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.renderArea = shadowMapRenderPassInfo.renderArea;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 0;
+    renderingInfo.pDepthAttachment = &depthAttachment;
+
+    pfnCmdBeginRendering(commandBuffer, &renderingInfo);
+  }
+  else
+  {
+    vkCmdBeginRenderPass(commandBuffer, &shadowMapRenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  }
 
 	VkViewport shadowMapViewport = {};
 	shadowMapViewport.x = 0.0f;
@@ -2624,24 +3771,43 @@ void recordShadowMapCommands(VkCommandBuffer commandBuffer)
 	shadowMapScissor.extent = shadowMapExtent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &shadowMapScissor);
 
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowMapGraphicsPipeline);
 
-    std::vector<VkBuffer> vertexBuffers = {Models[gameObject.modelName].vertexBuffer};
+    std::vector<VkBuffer> vertexBuffers = {renderable.model->vertexBuffer};
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(commandBuffer, 0, vertexBuffers.size(), vertexBuffers.data(), offsets);
-    vkCmdBindIndexBuffer(commandBuffer, Models[gameObject.modelName].indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(commandBuffer, renderable.model->indexBuffer, 0, renderable.model->indexType);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowMapPipelineLayout, 0, 1, &gameObject.shadowMapDescriptorSets[currentFrame], 0, NULL);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(Models[gameObject.modelName].indices.size()), 1, 0, 0, 0);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowMapPipelineLayout, 0, 1, &renderable.shadowMapDescriptorSets[currentFrame], 0, NULL);
+    const struct MeshLod& lod = renderable.model->lods[renderable.lod];
+    vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
   }
 
-	vkCmdEndRenderPass(commandBuffer);
+  if (useDynamicRendering)
+  {
+    pfnCmdEndRendering(commandBuffer);
+    transitionShadowMapToRead(commandBuffer);
+  }
+  else
+  {
+    // the render pass moves the shadow map to DEPTH_STENCIL_READ_ONLY_OPTIMAL itself
+    vkCmdEndRenderPass(commandBuffer);
+  }
 }
 
 void transitionShadowMapToRead(VkCommandBuffer commandBuffer)
 {
+  if (useDynamicRendering)
+  {
+    cmdImageBarrier2(commandBuffer, shadowMapImage, VK_IMAGE_ASPECT_DEPTH_BIT, 1,
+        VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+    return;
+  }
+
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
@@ -2671,7 +3837,7 @@ void recordMainRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex
 	renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
 
 	renderPassInfo.renderArea.offset = {0, 0};
-	renderPassInfo.renderArea.extent = swapChainExtent;
+	renderPassInfo.renderArea.extent = renderExtent;
 
 	VkClearValue clearColor[2] = {};
   clearColor[0].color = {0.63f, 0.76f, 1.0f, 1.0f};
@@ -2680,37 +3846,254 @@ void recordMainRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex
 	renderPassInfo.clearValueCount = 2;
 	renderPassInfo.pClearValues = clearColor;
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  if (useDynamicRendering)
+  {
+    beginMainRendering(commandBuffer, imageIndex, clearColor);
+  }
+  else
+  {
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  }
 
 	VkViewport viewport = {};
 	viewport.x = 0.0f;
 	viewport.y = 0.0f;
-	viewport.width = (float)(swapChainExtent.width);
-	viewport.height = (float)(swapChainExtent.height);
+	viewport.width = (float)(renderExtent.width);
+	viewport.height = (float)(renderExtent.height);
 	viewport.minDepth = 0.0f;
 	viewport.maxDepth = 1.0f;
 	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
 	VkRect2D scissor = {};
 	scissor.offset = {0, 0};
-	scissor.extent = swapChainExtent;
+	scissor.extent = renderExtent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-  for (auto& gameObject : gameObjects)
+  if (depthPrePass)
+  {
+    recordObjectDraws(commandBuffer, depthPrePassGraphicsPipeline);
+  }
+
+  if (measureOverdraw)
+    vkCmdBeginQuery(commandBuffer, overdrawQueryPool, currentFrame, 0);
+
+  recordObjectDraws(commandBuffer, depthPrePass ? objectEqualGraphicsPipeline : objectGraphicsPipeline);
+
+  if (measureOverdraw)
+    vkCmdEndQuery(commandBuffer, overdrawQueryPool, currentFrame);
+
+  if (useDynamicRendering)
+    pfnCmdEndRendering(commandBuffer);
+  else
+    vkCmdEndRenderPass(commandBuffer);
+
+  if (useDynamicResolution)
+  {
+    // after the resolve, before the blit waits for the swap chain image
+    cmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, currentFrame * 2 + 1);
+    blitSceneToSwapChain(commandBuffer, imageIndex);
+  }
+  else if (useDynamicRendering)
   {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objectGraphicsPipeline);
+    cmdImageBarrier2(commandBuffer, swapChainImages[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT, 1,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, presentLayout);
+  }
+}
+
+void recordObjectDraws(VkCommandBuffer commandBuffer, VkPipeline pipeline)
+{
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+  // stays bound, set 0 changes per object below
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objectPipelineLayout, 1, 1, &textureDescriptorSet, 0, NULL);
 
-    std::vector<VkBuffer> vertexBuffers = {Models[gameObject.modelName].vertexBuffer};
+  for (auto& renderable : renderables.components)
+  {
+    std::vector<VkBuffer> vertexBuffers = {renderable.model->vertexBuffer};
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(commandBuffer, 0, vertexBuffers.size(), vertexBuffers.data(), offsets);
-    vkCmdBindIndexBuffer(commandBuffer, Models[gameObject.modelName].indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(commandBuffer, renderable.model->indexBuffer, 0, renderable.model->indexType);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objectPipelineLayout, 0, 1, &gameObject.descriptorSets[currentFrame], 0, NULL);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objectPipelineLayout, 0, 1, &renderable.descriptorSets[currentFrame], 0, NULL);
+    struct DrawConstants drawConstants = { renderable.texture, renderable.model->firstMaterial };
+    vkCmdPushConstants(commandBuffer, objectPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(drawConstants), &drawConstants);
     //vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(Models[gameObject.modelName].indices.size()), 1, 0, 0, 0);
+    const struct MeshLod& lod = renderable.model->lods[renderable.lod];
+    vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
   }
+}
+
+void blitSceneToSwapChain(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+  VkImageBlit blit = {};
+  blit.srcOffsets[0] = { 0, 0, 0 };
+  blit.srcOffsets[1] = { static_cast<int32_t>(renderExtent.width), static_cast<int32_t>(renderExtent.height), 1 };
+  blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  blit.srcSubresource.mipLevel = 0;
+  blit.srcSubresource.baseArrayLayer = 0;
+  blit.srcSubresource.layerCount = 1;
+  blit.dstOffsets[0] = { 0, 0, 0 };
+  blit.dstOffsets[1] = { static_cast<int32_t>(swapChainExtent.width), static_cast<int32_t>(swapChainExtent.height), 1 };
+  blit.dstSubresource = blit.srcSubresource;
+
+  if (useDynamicRendering)
+  {
+    // the swap chain barrier chains onto the acquire semaphore wait at TRANSFER
+    std::array<VkImageMemoryBarrier2, 2> barriers = {
+      imageBarrier2(sceneImage, VK_IMAGE_ASPECT_COLOR_BIT, 1,
+          VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+          VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL),
+      imageBarrier2(swapChainImages[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT, 1,
+          VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_NONE,
+          VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    };
+    cmdImageBarriers2(commandBuffer, barriers.size(), barriers.data());
+  }
+  else
+  {
+    // the render pass already left the scene image in TRANSFER_SRC_OPTIMAL
+    std::array<VkImageMemoryBarrier, 2> barriers = {};
+    for (auto& barrier : barriers)
+    {
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      barrier.subresourceRange.baseMipLevel = 0;
+      barrier.subresourceRange.levelCount = 1;
+      barrier.subresourceRange.baseArrayLayer = 0;
+      barrier.subresourceRange.layerCount = 1;
+    }
+    barriers[0].image = sceneImage;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[1].image = swapChainImages[imageIndex];
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    // TRANSFER in the source stages chains onto the acquire semaphore wait
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr,
+        barriers.size(), barriers.data());
+  }
+
+  vkCmdBlitImage(
+      commandBuffer,
+      sceneImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      swapChainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      1, &blit,
+      VK_FILTER_LINEAR
+    );
 
-	vkCmdEndRenderPass(commandBuffer);
+  if (useDynamicRendering)
+  {
+    cmdImageBarrier2(commandBuffer, swapChainImages[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT, 1,
+        VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, presentLayout);
+  }
+  else
+  {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = presentLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapChainImages[imageIndex];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0, 0, nullptr, 0, nullptr,
+        1, &barrier);
+  }
+}
+
+void beginMainRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, const VkClearValue* clearValues)
+{
+  VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (hasStencilComponent(findDepthFormat()))
+    depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+  // the semaphore wait happens at COLOR_ATTACHMENT_OUTPUT, so the swap chain
+  // image barrier chains onto it; color and depth only need WAW against the last frame
+  VkImage targetImage = useDynamicResolution ? sceneImage : swapChainImages[imageIndex];
+  VkImageView targetImageView = useDynamicResolution ? sceneImageView : swapChainImageViews[imageIndex];
+
+  std::array<VkImageMemoryBarrier2, 3> barriers = {
+    imageBarrier2(targetImage, VK_IMAGE_ASPECT_COLOR_BIT, 1,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_NONE,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+    imageBarrier2(colorImage, VK_IMAGE_ASPECT_COLOR_BIT, 1,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+    imageBarrier2(depthImage, depthAspect, 1,
+        VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+  };
+  cmdImageBarriers2(commandBuffer, barriers.size(), barriers.data());
+
+  VkRenderingAttachmentInfo colorAttachment = {};
+  colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+  colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  colorAttachment.clearValue = clearValues[0];
+  if (msaaSamples != VK_SAMPLE_COUNT_1_BIT)
+  {
+    // multisampled image is only needed until the resolve
+    colorAttachment.imageView = colorImageView;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+    colorAttachment.resolveImageView = targetImageView;
+    colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  }
+  else
+  {
+    colorAttachment.imageView = targetImageView;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+  }
+
+  VkRenderingAttachmentInfo depthAttachment = {};
+  depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+  depthAttachment.imageView = depthImageView;
+  depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  depthAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+  depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depthAttachment.clearValue = clearValues[1];
+
+  VkRenderingInfo renderingInfo = {};
+  renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+  renderingInfo.renderArea.offset = {0, 0};
+  renderingInfo.renderArea.extent = renderExtent;
+  renderingInfo.layerCount = 1;
+  renderingInfo.colorAttachmentCount = 1;
+  renderingInfo.pColorAttachments = &colorAttachment;
+  renderingInfo.pDepthAttachment = &depthAttachment;
+
+  pfnCmdBeginRendering(commandBuffer, &renderingInfo);
 }
 
 void cleanupSwapChain();
@@ -2735,11 +4118,16 @@ void recreateSwapChain()
 
   cleanResources();
   createColorResources();
+  createSceneResources();
   //createShadowMapResources();
   createDepthResources();
 
-  createFramebufferForShadowMap();
-	createFramebuffers();
+  // dynamic rendering has no framebuffers to rebuild
+  if (!useDynamicRendering)
+  {
+    createFramebufferForShadowMap();
+    createFramebuffers();
+  }
 }
 
 // Cleanup
@@ -2750,10 +4138,11 @@ void DestroySwapChainDetails(struct SwapChainSupportDetails *details);
 void Cleanup()
 {
 	cleanupSwapChain();
-  // textureImage
-  vkDestroyImageView(device, textureImageView, NULL);
-  vkDestroyImage(device, textureImage, NULL);
-  vkFreeMemory(device, textureImageMemory, NULL);
+  // replaced buffers and images, and reloads still running
+  destroyHotReload();
+  // textures, streaming reads from the pack until here
+  destroyTextures();
+  closeAssetPack();
   vkDestroySampler(device, textureSampler, NULL);
   // color and depth resources + shadow map
   cleanResources();
@@ -2763,20 +4152,22 @@ void Cleanup()
   vkFreeMemory(device, shadowMapImageMemory, NULL);
   vkDestroySampler(device, shadowMapSampler, NULL);
   // uniform buffers
-  for (auto& gameObject : gameObjects)
+  for (auto& renderable : renderables.components)
   {
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-      vkDestroyBuffer(device, gameObject.shadowMapUniformBuffers[i], NULL);
-      vkFreeMemory(device, gameObject.shadowMapUniformBuffersMemory[i], NULL);
-      vkDestroyBuffer(device, gameObject.uniformBuffers[i], NULL);
-      vkFreeMemory(device, gameObject.uniformBuffersMemory[i], NULL);
+      vkDestroyBuffer(device, renderable.shadowMapUniformBuffers[i], NULL);
+      vkFreeMemory(device, renderable.shadowMapUniformBuffersMemory[i], NULL);
+      vkDestroyBuffer(device, renderable.uniformBuffers[i], NULL);
+      vkFreeMemory(device, renderable.uniformBuffersMemory[i], NULL);
     }
   }
 	vkDestroyDescriptorPool(device, shadowMapDescriptorPool, NULL);
 	vkDestroyDescriptorPool(device, descriptorPool, NULL);
+  vkDestroyDescriptorPool(device, textureDescriptorPool, NULL);
 	vkDestroyDescriptorSetLayout(device, shadowMapDescriptorSetLayout, NULL);
 	vkDestroyDescriptorSetLayout(device, descriptorSetLayout, NULL);
+  vkDestroyDescriptorSetLayout(device, textureDescriptorSetLayout, NULL);
   for (auto& model : Models)
   {
     vkDestroyBuffer(device, model.second.vertexBuffer, NULL);
@@ -2784,7 +4175,13 @@ void Cleanup()
     vkFreeMemory(device, model.second.vertexBufferMemory, NULL);
     vkFreeMemory(device, model.second.indexBufferMemory, NULL);
   }
+  vkDestroyBuffer(device, materialBuffer, NULL);
+  vkFreeMemory(device, materialBufferMemory, NULL);
 	vkDestroyPipeline(device, objectGraphicsPipeline, NULL);
+	vkDestroyPipeline(device, depthPrePassGraphicsPipeline, NULL);
+	vkDestroyPipeline(device, objectEqualGraphicsPipeline, NULL);
+	vkDestroyQueryPool(device, overdrawQueryPool, NULL);
+	vkDestroyQueryPool(device, timestampQueryPool, NULL);
 	vkDestroyPipeline(device, shadowMapGraphicsPipeline, NULL);
 	vkDestroyPipelineLayout(device, objectPipelineLayout, NULL);
 	vkDestroyPipelineLayout(device, shadowMapPipelineLayout, NULL);
@@ -2798,16 +4195,19 @@ void Cleanup()
 	}	
 	vkDestroyCommandPool(device, commandPool, NULL);
 	vkDestroyDevice(device, NULL);
-	vkDestroySurfaceKHR(instance, surface, NULL);
+  if (!headless)
+    vkDestroySurfaceKHR(instance, surface, NULL);
 	vkDestroyInstance(instance, NULL);
 	DestroySwapChainDetails(&swapChainSupport);
-	glfwDestroyWindow(window);
-	glfwTerminate();
+  if (!headless)
+  {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
 }
 
 void cleanupSwapChain()
 {
-  cleanSwapChainImages();
 	for (size_t i = 0; i < swapChainFramebufferCount; i++)
 	{
 		vkDestroyFramebuffer(device, swapChainFramebuffers[i], NULL);
@@ -2820,7 +4220,21 @@ void cleanupSwapChain()
 
   vkDestroyFramebuffer(device, shadowMapFramebuffer, NULL);
 
-	vkDestroySwapchainKHR(device, swapChain, NULL);
+  if (headless)
+  {
+    // the offscreen images are ours, swap chain images belong to the swap chain
+    for (size_t i = 0; i < swapChainImageCount; i++)
+    {
+      vkDestroyImage(device, swapChainImages[i], NULL);
+      vkFreeMemory(device, offscreenImageMemories[i], NULL);
+    }
+    free(offscreenImageMemories);
+  }
+  else
+  {
+    vkDestroySwapchainKHR(device, swapChain, NULL);
+  }
+  cleanSwapChainImages();
 }
 
 void DestroySwapChainDetails(struct SwapChainSupportDetails *details)
@@ -31,9 +31,11 @@
 #include <chrono>
 #include <string>
 #include <limits>
+#include <algorithm>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <cmath>
 #define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -44,17 +46,31 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/scalar_constants.hpp>
 
-#include "lib/base64.hxx"
 #include "lib/validationLayers.hxx"
+#include "lib/mappedFile.hxx"
+#include "lib/threadPool.hxx"
+#include "lib/assetPack.hxx"
+#include "lib/ktx2.hxx"
 #include "lib/3d.hxx"
+#include "lib/snapshots.hxx"
 #include "lib/physics.hxx"
 #include "lib/vulkanInit.hxx"
 
-int main()
+int main(int argc, char** argv)
 {
   std::cout << "VulkanFlappyBird v"
     << VulkanFlappyBird_VERSION_MAJOR << "."
     << VulkanFlappyBird_VERSION_MINOR << "\n\n";
+  // --headless [frames]
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--headless") == 0)
+    {
+      headless = true;
+      if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+        headlessFrameCount = static_cast<uint32_t>(atoi(argv[++i]));
+    }
+  }
   //fetchObj();
 	Run();
 